@@ -11,9 +11,20 @@ ArgumentValue& ArgumentValue::operator=<bool>(const bool& other){
 }
 
 // Casting Operators {{{2
-ArgumentValue::operator int() const{return strtol(c_str(), nullptr, 10);}
-ArgumentValue::operator float() const{return strtof(c_str(), nullptr);}
-ArgumentValue::operator double() const{return strtod(c_str(), nullptr);}
+// Leniently, like strtol/strtod: the leading number of "12abc", the integer
+// part of "3.7". parse_number() handles the common case without the libc call
+ArgumentValue::operator int() const{
+	int num = 0;
+	return parse_number(*this, num)? num : strtol(c_str(), nullptr, 10);
+}
+ArgumentValue::operator float() const{
+	float num = 0;
+	return parse_number(*this, num)? num : strtof(c_str(), nullptr);
+}
+ArgumentValue::operator double() const{
+	double num = 0;
+	return parse_number(*this, num)? num : strtod(c_str(), nullptr);
+}
 ArgumentValue::operator bool() const{return *this == TRUE;}
 
 // Comparison Operators {{{2
@@ -82,9 +93,9 @@ ArgumentValueList& ArgumentValueList::operator=(const std::vector<std::string>&
 }
 
 // Casting Operators {{{2
-ArgumentValueList::operator int() const{return strtol(at(0).c_str(), nullptr, 10);}
-ArgumentValueList::operator float() const{return strtof(at(0).c_str(), nullptr);}
-ArgumentValueList::operator double() const{return strtod(at(0).c_str(), nullptr);}
+ArgumentValueList::operator int() const{return at(0);}
+ArgumentValueList::operator float() const{return at(0);}
+ArgumentValueList::operator double() const{return at(0);}
 ArgumentValueList::operator bool() const{return at(0) == TRUE;}
 ArgumentValueList::operator std::string() const{return at(0);}
 
@@ -155,7 +166,284 @@ std::vector<std::string> ArgumentValueList::vec() const{
 }
 
 
+// === HANDLES === {{{1
+//
+// Constructors {{{2
+Handle::Handle() : _slot(-1){}
+Handle::Handle(int slot) : _slot(slot){}
+
+// Accessors {{{2
+bool Handle::valid() const{return _slot >= 0;}
+
+
+// === PARSE RESULTS === {{{1
+//
+// Constructor {{{2
+ParseResult::ParseResult(std::pmr::memory_resource* mem) 
+		: _status(Status::Ok), _parser(nullptr), _usage(false), _dests(nullptr), 
+		_vals(mem), _found(mem), _depth(1), _others(mem), _argv(nullptr), _argc(0){}
+
+// Private Modifiers {{{2
+void ParseResult::fail(const ArgumentParser* parser, std::string msg, bool usage){
+	ARGPARSE_TRACE_EVENT("error", msg);
+	_status = Status::Error;
+	_parser = parser;
+	_msg = msg;
+	_usage = usage;
+}
+std::string_view ParseResult::keep(std::string_view str){
+	if (!_owned){
+		std::pmr::polymorphic_allocator<std::byte> alloc(resource());
+		_owned = std::allocate_shared<std::pmr::deque<std::pmr::string>>(alloc);
+	}
+	_owned->emplace_back(str);
+	return _owned->back();
+}
+std::string_view ParseResult::keep_line(std::string_view line, std::pmr::memory_resource* mem){
+	if (!_lines){
+		std::pmr::polymorphic_allocator<std::byte> alloc(mem);
+		_lines = std::allocate_shared<std::pmr::deque<std::pmr::string>>(alloc);
+	}
+	_lines->emplace_back(line);
+	return _lines->back();
+}
+void ParseResult::prepare(const Dests* dests){
+	_dests = dests;
+	int size = dests->size();
+	_vals.resize(size);
+	_found.assign(size, 0);
+}
+void ParseResult::resize(){
+	// Lazy subparsers add their destinations when they are built, which may
+	// be after the result was prepared
+	int size = _dests->size();
+	if (_vals.size() < size){
+		_vals.resize(size);
+		_found.resize(size, 0);
+	}
+}
+ParseResult::Values& ParseResult::slot(int index){
+	_found[index] = _depth;
+	return _vals[index];
+}
+
+// Modifiers {{{2
+ParseResult& ParseResult::own(){
+	// Copy every value into a fresh store so that the result no longer
+	// refers to argv (or to any store shared with other results)
+	auto old = _owned, lines = _lines;
+	_owned = _lines = nullptr;
+	_argv = nullptr;
+	for (int i=0; i<_vals.size(); i++)
+		if (_found[i])
+			for (auto& val : _vals[i].str)
+				val = keep(val);
+	return *this;
+}
+
+// Accessors {{{2
+std::pmr::memory_resource* ParseResult::resource() const{
+	return _vals.get_allocator().resource();
+}
+bool ParseResult::ok() const{return _status == Status::Ok;}
+bool ParseResult::help() const{return _status == Status::Help;}
+bool ParseResult::version() const{return _status == Status::Version;}
+const std::string& ParseResult::message() const{return _msg;}
+const ArgumentParser& ParseResult::parser() const{return *_parser;}
+ArgumentMap ParseResult::args() const{
+	ArgumentMap args;
+	if (_vals.size() == 0) return args;
+	std::shared_lock<std::shared_mutex> guard(_dests->lock);
+	for (int i=0; i<_vals.size(); i++){
+		if (!_found[i]) continue;
+		std::vector<std::string> vals;
+		for (int k=0; k<_vals[i].size(); k++)
+			vals.push_back(_vals[i].text(k));
+		args[_dests->names[i]] = vals;
+	}
+	return args;
+}
+Handle ParseResult::handle(std::string_view dest) const{
+	return Handle(_dests? _dests->find(dest) : -1);
+}
+const ParseResult::Values* ParseResult::find(Handle dest) const{
+	if (dest._slot < 0 || dest._slot >= _vals.size() || !_found[dest._slot])
+		return nullptr;
+	return &_vals[dest._slot];
+}
+const ParseResult::Values& ParseResult::at(Handle dest) const{
+	const Values* vals = find(dest);
+	if (!vals) throw std::out_of_range("argparse: destination has no values");
+	return *vals;
+}
+const ParseResult::ViewList& ParseResult::values(std::string_view dest) const{
+	return values(handle(dest));
+}
+const ParseResult::ViewList& ParseResult::values(Handle dest) const{
+	static const ViewList empty;
+	const Values* vals = find(dest);
+	return vals? vals->str : empty;
+}
+template <>
+int ParseResult::get<int>(Handle dest, int index) const{
+	const Values& vals = at(dest);
+	if (index < vals.num.size()){
+		if (auto num = std::get_if<int>(&vals.num[index])) return *num;
+		if (auto num = std::get_if<double>(&vals.num[index])) return *num;
+		if (auto num = std::get_if<bool>(&vals.num[index])) return *num;
+	}
+	int num = 0;
+	std::string text = vals.text(index);
+	return parse_number(text, num)? num : strtol(text.c_str(), nullptr, 10);
+}
+template <>
+double ParseResult::get<double>(Handle dest, int index) const{
+	const Values& vals = at(dest);
+	if (index < vals.num.size()){
+		if (auto num = std::get_if<int>(&vals.num[index])) return *num;
+		if (auto num = std::get_if<double>(&vals.num[index])) return *num;
+		if (auto num = std::get_if<bool>(&vals.num[index])) return *num;
+	}
+	double num = 0;
+	std::string text = vals.text(index);
+	return parse_number(text, num)? num : strtod(text.c_str(), nullptr);
+}
+template <>
+float ParseResult::get<float>(Handle dest, int index) const{
+	return get<double>(dest, index);
+}
+template <>
+bool ParseResult::get<bool>(Handle dest, int index) const{
+	const Values& vals = at(dest);
+	if (index < vals.num.size())
+		if (auto num = std::get_if<bool>(&vals.num[index])) return *num;
+	return vals.text(index) == TRUE;
+}
+template <>
+std::string ParseResult::get<std::string>(Handle dest, int index) const{
+	return at(dest).text(index);
+}
+ArgumentValueList ParseResult::operator[](std::string_view dest) const{
+	return (*this)[handle(dest)];
+}
+ArgumentValueList ParseResult::operator[](Handle dest) const{
+	const Values* found = find(dest);
+	if (!found) return ArgumentValueList();
+	std::vector<std::string> vals;
+	for (int i=0; i<found->size(); i++)
+		vals.push_back(found->text(i));
+	return vals;
+}
+
+ParseResult::Span ParseResult::span(std::string_view dest) const{
+	return span(handle(dest));
+}
+ParseResult::Span ParseResult::span(Handle dest) const{
+	// The values are found in _argv by address, checking that they are the
+	// whole of consecutive tokens (starting with the end of _argv)
+	const Values* vals = find(dest);
+	if (!vals || !_argv || vals->str.size() == 0 || vals->str.size() > _argc) 
+		return Span{nullptr, 0};
+	const ViewList& str = vals->str;
+	int first = _argc - str.size();
+	if (_argv[first] != str[0].data()){
+		first = -1;
+		for (int k=0; k+str.size()<=_argc && first<0; k++)
+			if (_argv[k] == str[0].data()) first = k;
+		if (first < 0) return Span{nullptr, 0};
+	}
+	for (int k=0; k<str.size(); k++)
+		if (_argv[first+k] != str[k].data() || _argv[first+k][str[k].size()] != '\0')
+			return Span{nullptr, 0};
+	return Span{_argv+first, (int)str.size()};
+}
+
+// Span {{{2
+const char* const* ParseResult::Span::begin() const{return args;}
+const char* const* ParseResult::Span::end() const{return args+nargs;}
+int ParseResult::Span::size() const{return nargs;}
+bool ParseResult::Span::empty() const{return nargs == 0;}
+
+// Dests {{{2
+int ParseResult::Dests::add(std::string_view name){
+	std::unique_lock<std::shared_mutex> guard(lock);
+	return insert(name);
+}
+int ParseResult::Dests::insert(std::string_view name){
+	if (name == "") return -1;
+	auto it = index.find(name);
+	if (it != index.end()) return it->second;
+	names.emplace_back(name);
+	index[names.back()] = names.size()-1;
+	return names.size()-1;
+}
+int ParseResult::Dests::find(std::string_view name) const{
+	std::shared_lock<std::shared_mutex> guard(lock);
+	auto it = index.find(name);
+	return (it == index.end())? -1 : it->second;
+}
+int ParseResult::Dests::size() const{
+	std::shared_lock<std::shared_mutex> guard(lock);
+	return names.size();
+}
+
+// Binding {{{2
+const ParseResult& ParseResult::store() const{
+	return store(nullptr, nullptr);
+}
+const ParseResult& ParseResult::store(void* target, const std::type_info* type) const{
+	if (!_dests) return *this;
+	std::shared_lock<std::shared_mutex> guard(_dests->lock);
+	int nbinds = std::min(_vals.size(), _dests->binds.size());
+	for (int i=0; i<nbinds; i++){
+		const Binding& bind = _dests->binds[i];
+		if (!_found[i] || !bind.write) continue;
+		if (bind.type == nullptr || (type != nullptr && *bind.type == *type))
+			bind.write(*this, Handle(i), target);
+	}
+	return *this;
+}
+
+// Values {{{2
+ParseResult::Values::Values(allocator_type alloc) : str(alloc), num(alloc){}
+ParseResult::Values::Values(const Values& other, allocator_type alloc) 
+		: str(other.str, alloc), num(other.num, alloc){}
+ParseResult::Values::Values(Values&& other, allocator_type alloc) 
+		: str(std::move(other.str), alloc), num(std::move(other.num), alloc){}
+void ParseResult::Values::assign(std::string_view val){
+	str.assign(1, val);
+	num.assign(1, std::monostate());
+}
+int ParseResult::Values::size() const{
+	return std::max(str.size(), num.size());
+}
+std::string ParseResult::Values::text(int index) const{
+	if (index < str.size()) return std::string(str[index]);
+	const Number& val = num.at(index);
+	if (auto num = std::get_if<int>(&val)) return std::to_string(*num);
+	if (auto num = std::get_if<bool>(&val)) return *num? TRUE : FALSE;
+	std::ostringstream ss;
+	if (auto num = std::get_if<double>(&val)) ss << *num;
+	return ss.str();
+}
+
 // === HELPERS === {{{1
+template <typename T>
+bool argparse::parse_number(std::string_view str, T& num){
+	// An explicit '+' is allowed (as it is by strtol and strtod)
+	if (str.size() > 1 && str[0] == '+' && str[1] != '+' && str[1] != '-')
+		str.remove_prefix(1);
+	const char* end = str.data() + str.size();
+	auto result = std::from_chars(str.data(), end, num);
+	return result.ec == std::errc() && result.ptr == end;
+}
+template bool argparse::parse_number(std::string_view str, int& num);
+template bool argparse::parse_number(std::string_view str, unsigned& num);
+template bool argparse::parse_number(std::string_view str, long long& num);
+template bool argparse::parse_number(std::string_view str, unsigned long long& num);
+template bool argparse::parse_number(std::string_view str, float& num);
+template bool argparse::parse_number(std::string_view str, double& num);
+
 std::string argparse::format_args(ArgumentMap args){
 	std::string result = "Namespace(";
 	bool first = true;
@@ -185,13 +473,17 @@ void argparse::print_args(ArgumentMap args, std::ostream& out){
 // 
 // Constructor {{{2
 ArgumentParser::ArgumentParser(int nargs, char **args) 
-		: _nargs(nargs-1), _req_posargs(0), _base_req_posargs(0),
-		_help_indent(0), _subparser_index(0), _none_str(NONE){
+		: _nargs(nargs-1), _none_str(NONE), _dests(std::make_shared<ParseResult::Dests>()),
+		_req_posargs(0), _first_collection(-1), _remainder_start(-1),
+		_stats(std::make_shared<ParserStats>()), _format(HelpFormatter::Default),
+		_snapshots(nullptr), _nsnapshots(0), _subparser_index(0){
 	// Set booleans
 	_resolve = _added_help =  false;
-	_parsed = _has_digit_opt = _multiline_usage = false;
+	_frozen = false;
+	_shortidx.fill(-1);
+	_parsed = _has_digit_opt = false;
 	_override_usage = _override_prog = _subparser = false;
-	_add_help = true;
+	_add_help = _allow_abbrev = true;
 	
 	// Set program name and _args.
 	size_t pos = ((std::string)args[0]).rfind('/');
@@ -203,14 +495,33 @@ ArgumentParser::ArgumentParser(int nargs, char **args)
 
 	// Format usage
 	_usage = "usage: " + _prog;
-	_usage_line_len = _usage.size();
-	_preusage_len = _usage_line_len;
 	
 	// Set the linecap for line-wrapping from terminal width
 	struct winsize w;
 	ioctl(0, TIOCGWINSZ, &w);
 	_linecap = w.ws_col-2;
 }
+ArgumentParser::ArgumentParser(const ArgumentParser& base, std::string cmd)
+		: _nargs(0), _none_str(NONE), _dests(base._dests), _req_posargs(0),
+		_first_collection(-1), _remainder_start(-1), _stats(base._stats),
+		_format(HelpFormatter::Default), _snapshots(nullptr), _nsnapshots(0),
+		_subparser_index(0){
+	// Set booleans
+	_resolve = _added_help =  false;
+	_frozen = false;
+	_shortidx.fill(-1);
+	_parsed = _has_digit_opt = false;
+	_override_usage = _override_prog = false;
+	_add_help = _allow_abbrev = true;
+	_subparser = true;
+	_subparser_cmd = cmd;
+	
+	// The program name is replaced when the base parser is frozen, and the
+	// linecap is the base's (so that the terminal is only queried once)
+	_prog = base._prog;
+	_usage = "usage: " + _prog;
+	_linecap = base._linecap;
+}
 
 // Error Handling {{{2
 void ArgumentParser::error(std::string msg){
@@ -225,16 +536,24 @@ void ArgumentParser::error(std::string msg){
 // Modifiers {{{2
 template <>
 ArgumentParser::Argument& ArgumentParser::add_argument<int>(std::string sname, std::string lname){
+	ARGPARSE_TIME(registration);
+	ARGPARSE_COUNT(registration, 1);
 	Argument arg(ArgType::Optarg, ValType::Int, sname, lname);
 	check_conflict(arg, ArgType::Optarg);
+	arg._dests = _dests.get();
+	arg._parser = this;
 	
 	_optlist.push_back(arg);
 	return _optlist.back();
 }
 template <>
 ArgumentParser::Argument& ArgumentParser::add_argument<float>(std::string sname, std::string lname){
+	ARGPARSE_TIME(registration);
+	ARGPARSE_COUNT(registration, 1);
 	Argument arg(ArgType::Optarg, ValType::Float, sname, lname);
 	check_conflict(arg, ArgType::Optarg);
+	arg._dests = _dests.get();
+	arg._parser = this;
 	
 	_optlist.push_back(arg);
 	return _optlist.back();
@@ -245,15 +564,23 @@ ArgumentParser::Argument& ArgumentParser::add_argument<double>(std::string sname
 }
 template <>
 ArgumentParser::Argument& ArgumentParser::add_argument<bool>(std::string sname, std::string lname){
+	ARGPARSE_TIME(registration);
+	ARGPARSE_COUNT(registration, 1);
 	Argument arg(ArgType::Optarg, ValType::Bool, sname, lname);
 	check_conflict(arg, ArgType::Optarg);
+	arg._dests = _dests.get();
+	arg._parser = this;
 	
 	_optlist.push_back(arg);
 	return _optlist.back();
 }
 ArgumentParser::Argument& ArgumentParser::add_argument(std::string sname, std::string lname){
+	ARGPARSE_TIME(registration);
+	ARGPARSE_COUNT(registration, 1);
 	Argument arg(ArgType::Optarg, ValType::String, sname, lname);
 	check_conflict(arg, ArgType::Optarg);
+	arg._dests = _dests.get();
+	arg._parser = this;
 	
 	_optlist.push_back(arg);
 	return _optlist.back();
@@ -261,6 +588,8 @@ ArgumentParser::Argument& ArgumentParser::add_argument(std::string sname, std::s
 
 template <>
 ArgumentParser::Argument& ArgumentParser::add_argument<int>(std::string name){
+	ARGPARSE_TIME(registration);
+	ARGPARSE_COUNT(registration, 1);
 	std::string sname = "", lname = "";
 	ArgType type = (name[0] == '-')? ArgType::Optarg : ArgType::Posarg;
 	if (type == ArgType::Optarg && name[1] == '-') lname = name;
@@ -268,6 +597,8 @@ ArgumentParser::Argument& ArgumentParser::add_argument<int>(std::string name){
 
 	Argument arg(type, ValType::Int, sname, lname);
 	check_conflict(arg, type);
+	arg._dests = _dests.get();
+	arg._parser = this;
 	if (type == ArgType::Optarg){
 		_optlist.push_back(arg);
 		return _optlist.back();
@@ -279,6 +610,8 @@ ArgumentParser::Argument& ArgumentParser::add_argument<int>(std::string name){
 }
 template <>
 ArgumentParser::Argument& ArgumentParser::add_argument<float>(std::string name){
+	ARGPARSE_TIME(registration);
+	ARGPARSE_COUNT(registration, 1);
 	std::string sname = "", lname = "";
 	ArgType type = (name[0] == '-')? ArgType::Optarg : ArgType::Posarg;
 	if (type == ArgType::Optarg && name[1] == '-') lname = name;
@@ -286,6 +619,8 @@ ArgumentParser::Argument& ArgumentParser::add_argument<float>(std::string name){
 
 	Argument arg(type, ValType::Float, sname, lname);
 	check_conflict(arg, type);
+	arg._dests = _dests.get();
+	arg._parser = this;
 	if (type == ArgType::Optarg){
 		_optlist.push_back(arg);
 		return _optlist.back();
@@ -301,6 +636,8 @@ ArgumentParser::Argument& ArgumentParser::add_argument<double>(std::string name)
 }
 template <>
 ArgumentParser::Argument& ArgumentParser::add_argument<bool>(std::string name){
+	ARGPARSE_TIME(registration);
+	ARGPARSE_COUNT(registration, 1);
 	std::string sname = "", lname = "";
 	if (name[0] != '-') error("invalid positional argument type: bool");
 	if (name[1] == '-') lname = name;
@@ -308,10 +645,14 @@ ArgumentParser::Argument& ArgumentParser::add_argument<bool>(std::string name){
 
 	Argument arg(ArgType::Optarg, ValType::Bool, sname, lname);
 	check_conflict(arg, ArgType::Optarg);
+	arg._dests = _dests.get();
+	arg._parser = this;
 	_optlist.push_back(arg);
 	return _optlist.back();
 }
 ArgumentParser::Argument& ArgumentParser::add_argument(std::string name){
+	ARGPARSE_TIME(registration);
+	ARGPARSE_COUNT(registration, 1);
 	std::string sname = "", lname = "";
 	ArgType type = (name[0] == '-')? ArgType::Optarg : ArgType::Posarg;
 	if (type == ArgType::Optarg && name[1] == '-') lname = name;
@@ -319,6 +660,8 @@ ArgumentParser::Argument& ArgumentParser::add_argument(std::string name){
 
 	Argument arg(type, ValType::String, sname, lname);
 	check_conflict(arg, type);
+	arg._dests = _dests.get();
+	arg._parser = this;
 	if (type == ArgType::Optarg){
 		_optlist.push_back(arg);
 		return _optlist.back();
@@ -329,6 +672,49 @@ ArgumentParser::Argument& ArgumentParser::add_argument(std::string name){
 	}
 }
 
+ArgumentParser& ArgumentParser::add_arguments(const std::vector<ArgumentSpec>& specs){
+	ARGPARSE_TIME(registration);
+	ARGPARSE_COUNT(registration, specs.size());
+	int nopts = 0;
+	for (const auto& spec : specs)
+		if (spec.names.substr(0, 1) == "-") nopts++;
+	// One more optarg for the help added by freeze()
+	_optlist.reserve(_optlist.size() + nopts + 1);
+	_arglist.reserve(_arglist.size() + specs.size() - nopts);
+	
+	for (const auto& spec : specs){
+		std::string sname = spec.names.substr(0, spec.names.find(',')), lname = "";
+		if (sname.size() < spec.names.size()) lname = spec.names.substr(sname.size()+1);
+		else if (sname.substr(0, 2) == "--") std::swap(sname, lname);
+		ArgType type = (spec.names.substr(0, 1) == "-")? ArgType::Optarg : ArgType::Posarg;
+		ValType valtype = ValType::String;
+		if (spec.type == "int") valtype = ValType::Int;
+		else if (spec.type == "float" || spec.type == "double") valtype = ValType::Float;
+		else if (spec.type == "bool") valtype = ValType::Bool;
+		else if (spec.type != "" && spec.type != "str") error("invalid argument type: " + spec.type);
+		if (valtype == ValType::Bool && type == ArgType::Posarg) 
+			error("invalid positional argument type: bool");
+		
+		Argument arg(type, valtype, sname, lname);
+		check_conflict(arg, type);
+		arg._dests = _dests.get();
+		arg._parser = this;
+		std::vector<Argument>& list = (type == ArgType::Optarg)? _optlist : _arglist;
+		list.push_back(std::move(arg));
+		Argument& added = list.back();
+		int count;
+		if (parse_number(spec.nargs, count)) added.nargs(count);
+		else if (spec.nargs != "") added.nargs(spec.nargs);
+		if (spec.choices != "") added.choices(spec.choices);
+		if (spec.def != "") added.def(spec.def);
+		if (spec.dest != "") added.dest(spec.dest);
+		if (spec.metavar != "") added.metavar(spec.metavar);
+		if (spec.help != "") added.help(spec.help);
+		added.required(spec.required);
+	}
+	return *this;
+}
+
 ArgumentParser::SubparserList& ArgumentParser::add_subparsers(){
 	if (_subparsers.valid()) error("cannot have multiple subparser arguments");
 	_subparsers.add(this);
@@ -340,9 +726,8 @@ ArgumentParser& ArgumentParser::prog(std::string prog){
 	if (!_override_prog){
 		_prog = prog;
 		_override_prog = true;
+		_frozen = false;
 		_usage = "usage: " + _prog;
-		_usage_line_len = _usage.size(); 
-		_preusage_len = _usage_line_len;
 	}
 	return *this;
 }
@@ -350,20 +735,24 @@ ArgumentParser& ArgumentParser::usage(std::string usage){
 	if (!_override_usage){
 		_usage = "usage: " + usage;
 		_override_usage = true;
+		_frozen = false;
 	}
 	return *this;
 }
 
 ArgumentParser& ArgumentParser::description(std::string desc){
 	if (_desc == "") _desc = desc;
+	_frozen = false;
 	return *this;
 	}
 ArgumentParser& ArgumentParser::epilog(std::string epilog){
 	if (_epilog == "") _epilog = epilog;
+	_frozen = false;
 	return *this;
 }
 ArgumentParser& ArgumentParser::add_help(bool add_help){
 	_add_help = add_help;
+	_frozen = false;
 	return *this;
 }
 ArgumentParser& ArgumentParser::argument_default(std::string def){
@@ -373,6 +762,7 @@ ArgumentParser& ArgumentParser::argument_default(std::string def){
 ArgumentParser& ArgumentParser::parent(const ArgumentParser& parser){
 	for (int i=0; i<parser._optlist.size(); i++){
 		Argument arg = parser._optlist[i];
+		if (arg._sname == "" && arg._lname == "") continue;
 		if (arg._valtype == ValType::Int)
 			add_argument<int>(arg._sname, arg._lname);
 		else if (arg._valtype == ValType::Float)
@@ -403,6 +793,11 @@ ArgumentParser& ArgumentParser::conflict_handler(std::string name){
 }
 ArgumentParser& ArgumentParser::formatter_class(HelpFormatter format){
 	_format = format;
+	_frozen = false;
+	return *this;
+}
+ArgumentParser& ArgumentParser::allow_abbrev(bool allow_abbrev){
+	_allow_abbrev = allow_abbrev;
 	return *this;
 }
 ArgumentParser& ArgumentParser::fromfile_prefix_chars(std::string prefix){
@@ -412,27 +807,102 @@ ArgumentParser& ArgumentParser::fromfile_prefix_chars(std::string prefix){
 ArgumentParser& ArgumentParser::set_defaults(
 		std::map<std::string, std::string> defaults){
 	if (_defaults.size() == 0) _defaults = defaults;
+	_frozen = false;
 	return *this;
 }
 
 ArgumentParser& ArgumentParser::help(std::string help){
 	if (_subparser && help != "") _subparser_help = trim(help);
+	_frozen = false;
 	return *this;
 }
 
 ArgumentParser& ArgumentParser::set_linecap(int linecap){
 	if (linecap > 0) _linecap = linecap;
+	_frozen = false;
+	return *this;
+}
+
+ArgumentParser& ArgumentParser::reset_stats(){
+	_stats->reset();
+	return *this;
+}
+
+ArgumentParser& ArgumentParser::precompiled_help(const HelpSnapshot* snapshots, int count){
+	_snapshots = snapshots;
+	_nsnapshots = count;
+	_frozen = false;
+	return *this;
+}
+
+ArgumentParser& ArgumentParser::freeze(){
+	if (!_frozen){
+		ARGPARSE_TIME(freeze);
+		ARGPARSE_COUNT(freeze, _optlist.size() + _arglist.size());
+		if (_add_help && !_added_help){
+			Argument arg(ArgType::Optarg, ValType::Bool, "-h", "--help");
+			arg.help("show this help message and exit");
+			arg._action = Action::Help;
+			check_conflict(arg, ArgType::Optarg);
+			_optlist.insert(_optlist.begin(), arg);
+			_added_help = true;
+		}
+		load_names();
+		
+		_helpargs.clear();
+		for (int i=0; i<_optlist.size(); i++)
+			if (_optlist[i]._valtype == ValType::Bool && _optlist[i]._action == Action::Help)
+				_helpargs.push_back(i);
+		_req_posargs = 0;
+		_first_collection = -1;
+		_remainder_start = -1;
+		int fixed = 0;
+		for (int i=0; i<_arglist.size(); i++){
+			if (_arglist[i]._required) _req_posargs++;
+			if (_first_collection < 0 && (_arglist[i]._more_nargs == '*' || _arglist[i]._more_nargs == '+'))
+				_first_collection = i;
+			if (_arglist[i]._more_nargs == '.'){
+				if (fixed >= 0 && _remainder_start < 0) _remainder_start = fixed;
+			}
+			else if (_arglist[i]._more_nargs == '\0' && fixed >= 0) fixed += _arglist[i]._nargs;
+			else fixed = -1;
+		}
+		
+		for (auto& arg : _optlist) arg.load_values();
+		for (auto& arg : _arglist) arg.load_values();
+		load_index();
+		load_subparser_progs();
+		_subparsers.load_commands();
+		if (_snapshots){
+			for (auto& parser : _subparsers._subparsers){
+				parser._snapshots = _snapshots;
+				parser._nsnapshots = _nsnapshots;
+				parser._frozen = false;
+			}
+		}
+		_helpcache.valid = false;
+		_frozen = true;
+	}
+	for (auto& parser : _subparsers._subparsers)
+		if (!parser._factory.build || parser._factory.built) parser.freeze();
 	return *this;
 }
 
 // Accessors {{{2
 std::string ArgumentParser::get_prog() const{return _prog;}
+bool ArgumentParser::frozen() const{return _frozen;}
+const ParserStats& ArgumentParser::stats() const{return *_stats;}
+MemoryStats ArgumentParser::memory() const{
+	MemoryStats stats;
+	add_memory(stats);
+	return stats;
+}
 ArgumentValueList ArgumentParser::get_default(std::string name) const{
 	for (const auto& it : _defaults)
 		if (it.first == name)
 			return std::vector<std::string>{it.second};
 	for (const auto& arg : _optlist)
-		if (arg._dest == name)
+		if (arg._dest == name && (arg._sname != "" || arg._lname != ""))
 			return arg._def;
 	for (const auto& arg : _arglist)
 		if (arg._dest == name)
@@ -440,386 +910,405 @@ ArgumentValueList ArgumentParser::get_default(std::string name) const{
 	return std::vector<std::string>{};
 }
 std::string ArgumentParser::format_usage(){
-	load_helpstring();
-	return _usage;
+	freeze();
+	return static_cast<const ArgumentParser*>(this)->format_usage();
+}
+std::string ArgumentParser::format_usage() const{
+	return std::string(helpstrings().usage);
 }
 std::string ArgumentParser::format_help(){
-	load_helpstring();
-	std::string helpstr;
-	helpstr += _usage;
-	if (_desc != "") helpstr += "\n\n" + wrap(_desc);
-	if (_arghelp != "") helpstr += "\n\n" + _arghelp;
-	if (_opthelp != "") helpstr += "\n\n" + _opthelp;
-	if (_subhelp != "") helpstr += "\n\n" + _subhelp;
-	if (_epilog != "") helpstr += "\n\n" + wrap(_epilog);
-	return helpstr;
+	freeze();
+	return static_cast<const ArgumentParser*>(this)->format_help();
+}
+std::string ArgumentParser::format_help() const{
+	return std::string(helpstrings().help);
 }
 void ArgumentParser::print_usage(std::ostream& out){
-	out << format_usage() << std::endl;
+	freeze();
+	static_cast<const ArgumentParser*>(this)->print_usage(out);
+}
+void ArgumentParser::print_usage(std::ostream& out) const{
+	out << helpstrings().usage << std::endl;
 }
 void ArgumentParser::print_help(std::ostream& out){
-	out << format_help() << std::endl;
+	freeze();
+	static_cast<const ArgumentParser*>(this)->print_help(out);
+}
+void ArgumentParser::print_help(std::ostream& out) const{
+	out << helpstrings().help << std::endl;
+}
+
+void ArgumentParser::write_help_snapshot(std::ostream& out, std::string name, 
+		const std::vector<int>& linecaps){
+	freeze();
+	out << "// Help of " << _prog << ", generated by argparse " 
+		<< "(include it after argparse.h). Do not edit\n";
+	out << "static const argparse::HelpSnapshot " << name << "[] = {\n";
+	snapshot_help(out, linecaps);
+	out << "};\n";
 }
 
 // Parser {{{2
 ArgumentMap ArgumentParser::parse_args(std::vector<std::string> argv){
-	if (argv.size() != 0){
-		_args = argv;
-		_nargs = argv.size();
+	freeze();
+#ifdef ARGPARSE_SNAPSHOT_BUILD
+	if (const char* path = getenv("ARGPARSE_HELP_SNAPSHOT")){
+		// Build step: write the help instead of parsing
+		std::vector<int> linecaps;
+		std::istringstream caps(getenv("ARGPARSE_HELP_LINECAPS")? 
+				getenv("ARGPARSE_HELP_LINECAPS") : "");
+		for (int linecap; caps >> linecap;) linecaps.push_back(linecap);
+		if (linecaps.empty()) linecaps.push_back(_linecap);
+		const char* name = getenv("ARGPARSE_HELP_NAME");
+		std::ofstream out(path);
+		write_help_snapshot(out, name? name : "help_snapshot", linecaps);
+		out.close();
+		exit(out? 0 : 1);
+	}
+#endif
+	ParseResult result;
+	if (argv.size() == 0){
+		std::pmr::vector<std::string_view> args(_args.begin(), _args.end());
+		parse_into(result, args.data(), args.data()+args.size(), 0);
+	}
+	else result = parse(argv);
+	
+	// The parser that ended the parse is either this one or one of its
+	// subparsers, so it is safe to modify it
+	ArgumentParser* parser = const_cast<ArgumentParser*>(result._parser);
+	if (result.help()){
+		result.parser().print_help();
+		exit(0);
 	}
-	if (_fromfile_prefix != ""){
-		_args = read_args_from_files(_args);
-		_nargs = _args.size();
+	if (result.version()){
+		std::cout << result.message() << std::endl;
+		exit(0);
+	}
+	if (!result.ok()){
+		parser->_parsed = result._usage;
+		parser->error(result.message());
 	}
-	ArgumentMap args;
-	for (const auto& it : _defaults)
-		args[it.first] = std::vector<std::string>{it.second};
-	
-	load_helpstring();
-
 	_parsed = true;
-	std::vector<Argument*> flags;
-	for (auto& arg : _optlist){
-		if (arg._valtype == ValType::Bool){
-			if (arg._action == Action::Help)
-				_helpargs.push_back(arg);
-			flags.push_back(&arg);
-		}
+	result.store();
+	return result.args();
+}
+
+ParseResult ArgumentParser::parse(const std::vector<std::string>& argv, 
+		std::pmr::memory_resource* mem) const{
+	// The strings may not outlive the result, so it owns its values
+	ParseResult result(mem);
+	if (!_frozen)
+		result.fail(this, "parser must be frozen before parsing", false);
+	else{
+		std::pmr::vector<std::string_view> args(argv.begin(), argv.end(), mem);
+		parse_into(result, args.data(), args.data()+args.size(), 0);
 	}
-	
-	int first_collection = -1, first_remainder = -1;
-	for (int i=0; i<_arglist.size(); i++){
-		if (_arglist[i]._required) _req_posargs++;
-		if (first_collection < 0 && (_arglist[i]._more_nargs == '*' || _arglist[i]._more_nargs == '+'))
-			first_collection = i;
-		if (first_remainder < 0 && _arglist[i]._more_nargs == '.')
-			first_remainder = i;
+	result.own();
+	return result;
+}
+ParseResult ArgumentParser::parse(int nargs, const char* const* args, 
+		std::pmr::memory_resource* mem) const{
+	// args[0] is the program name (as in the constructor). The result holds
+	// views into args, which must outlive it unless own() is called
+	ParseResult result(mem);
+	if (!_frozen)
+		result.fail(this, "parser must be frozen before parsing", false);
+	else{
+		std::pmr::vector<std::string_view> argv(args+std::min(nargs, 1), args+nargs, mem);
+		parse_into(result, argv.data(), argv.data()+argv.size(), 0);
+	}
+	result._argv = args;
+	result._argc = nargs;
+	return result;
+}
+
+std::vector<ParseResult> ArgumentParser::parse_many(
+		const std::vector<std::vector<std::string>>& batch, int nthreads) const{
+	std::vector<ParseResult> results(batch.size());
+	if (nthreads <= 0) nthreads = std::thread::hardware_concurrency();
+	if (nthreads > batch.size()) nthreads = batch.size();
+	if (nthreads <= 1){
+		for (int i=0; i<batch.size(); i++) results[i] = parse(batch[i]);
+		return results;
 	}
 	
+	// Building a lazy subparser adds destinations, which the workers read
+	build_all();
+	
+	// Each worker starts with an equal share of the batch and takes small
+	// chunks from the front of it. A worker that runs out steals the back
+	// half of another worker's remaining range, and stops once there is
+	// nothing left to steal.
+	struct Range {
+		std::mutex lock;
+		int begin, end;
+	};
+	const int chunk = 16;
+	std::vector<Range> ranges(nthreads);
+	for (int t=0; t<nthreads; t++){
+		ranges[t].begin = (long long)batch.size() * t / nthreads;
+		ranges[t].end = (long long)batch.size() * (t+1) / nthreads;
+	}
+	auto work = [&](int id){
+		Range& own = ranges[id];
+		while (true){
+			int begin, end;
+			{
+				std::lock_guard<std::mutex> guard(own.lock);
+				begin = own.begin;
+				end = std::min(own.begin + chunk, own.end);
+				own.begin = end;
+			}
+			if (begin >= end){
+				bool stolen = false;
+				for (int k=1; k<nthreads && !stolen; k++){
+					Range& victim = ranges[(id+k) % nthreads];
+					std::lock_guard<std::mutex> guard(victim.lock);
+					int left = victim.end - victim.begin;
+					if (left <= 0) continue;
+					begin = victim.end - (left+1)/2;
+					end = victim.end;
+					victim.end = begin;
+					stolen = true;
+				}
+				if (!stolen) return;
+				std::lock_guard<std::mutex> guard(own.lock);
+				own.begin = begin;
+				own.end = end;
+				continue;
+			}
+			for (int i=begin; i<end; i++) results[i] = parse(batch[i]);
+		}
+	};
+	
+	std::vector<std::thread> threads;
+	for (int t=1; t<nthreads; t++) threads.emplace_back(work, t);
+	work(0);
+	for (auto& thread : threads) thread.join();
+	return results;
+}
+
+void ArgumentParser::parse_into(ParseResult& result, const std::string_view* argv, 
+		const std::string_view* end, int base_req_posargs) const{
+	// Everything that lives for the whole parse is allocated from the
+	// result's memory resource, and the values are stored in the result.
+	// The tokens are a range of the caller's (a subparser gets the ones
+	// after its command), and are only copied to expand response files
+	ARGPARSE_TRACE_SPAN(parse, "parse", _prog);
+	std::pmr::memory_resource* mem = result.resource();
+	// Response files are read through the files resource of a
+	// CountingResource, so that they are counted apart from the results
+	std::pmr::memory_resource* files = mem;
+	if (_fromfile_prefix != "")
+		if (auto counter = dynamic_cast<CountingResource*>(mem)) files = &counter->_files;
+	std::pmr::vector<std::string_view> expanded(files);
+	if (_fromfile_prefix != ""){
+		ARGPARSE_TIME(files);
+		expanded = read_args_from_files(argv, end, result, files);
+		ARGPARSE_COUNT(files, expanded.size());
+		if (!result.ok()) return;
+		argv = expanded.data();
+		end = argv + expanded.size();
+	}
+	int nargs = end - argv;
+	// Subparsers parse into their base parser's result
+	if (result._depth == 1) result.prepare(_dests.get());
+	for (const auto& it : _defslots)
+		result.slot(it.first).assign(it.second);
+	
+	ParseState state(*this, mem);
+	std::pmr::vector<ParseState::Slot>& opt = state.opt;
+	std::pmr::vector<ParseState::Slot>& pos = state.pos;
+	
 	int help_index = -1, print_version = -1;
 	bool only_posargs = false;
-	std::vector<std::string> posargs;
-	std::vector<std::string> others;
-	std::string unrecognized = "";
+	std::pmr::vector<std::string_view> posargs(mem);
+	std::pmr::vector<std::string_view> others(mem);
+	const std::string_view* tail = end;
+	std::pmr::string unrecognized(mem);
+	ARGPARSE_TIME(optargs);
+	ARGPARSE_COUNT(optargs, nargs);
+	ARGPARSE_TRACE_SPAN(optargs, "phase", "optargs");
 	int shift = 1;
-	for (int i=0; i<_nargs; i+=shift){
+	for (int i=0; i<nargs; i+=shift){
 		shift = 1;
-		std::string given = _args[i];
+		std::string_view given = argv[i];
 		bool found = false;
+		if (_remainder_start >= 0 && (posargs.size() > _remainder_start 
+				|| (_remainder_start > 0 && posargs.size() == _remainder_start))){
+			// The REMAINDER posarg has started (with the first token after the
+			// posargs before it), so it takes every token left
+			ARGPARSE_TRACE_EVENT("token", given, {"index", std::to_string(i)}, 
+					{"kind", "remainder"}, {"values", std::to_string(nargs-i)});
+			posargs.insert(posargs.end(), argv+i, end);
+			break;
+		}
 		if (given == "--"){
+			ARGPARSE_TRACE_EVENT("token", given, {"index", std::to_string(i)}, {"kind", "separator"});
 			only_posargs = true;
 			continue;
 		}
 		
-		if (given[0] != '-' || only_posargs || (_subparsers.valid() && posargs.size() > _subparser_index))
+		if (given.substr(0, 1) != "-" || only_posargs || (_subparsers.valid() && posargs.size() > _subparser_index)){
+			ARGPARSE_TRACE_EVENT("token", given, {"index", std::to_string(i)}, {"kind", "posarg"});
 			posargs.push_back(given);
+			if (_subparsers.valid() && posargs.size() == _subparser_index+1){
+				// The tokens after the command are left as they are, to be
+				// passed on to the subparser
+				tail = argv+i+1;
+				break;
+			}
+		}
 		else{
-			for (int j=0; j<_helpargs.size(); j++){
-				char sname = (_helpargs[j]._sname != "")? 
-					_helpargs[j]._sname[1] : '\0';
-				std::string lname = _helpargs[j]._lname;
-				
-				if (contains(given, sname, true) || given == lname){
-					help_index = i;
+			// j is the optarg that takes values from this token (if any),
+			// and attached is the value given within the token itself
+			int j = -1;
+			bool has_attached = false;
+			std::string_view attached;
+			std::string_view name = given.substr(0, given.find('='));
+			int lidx = match_long(name);
+			if (lidx == -2) return result.fail(this, ambiguous_option(name));
+			if (lidx >= 0){
+				// Long form (or an abbreviation of it)
+				const Argument& arg = _optlist[lidx];
+				if (arg._valtype != ValType::Bool){
+					j = lidx;
+					has_attached = (name.size() < given.size());
+					if (has_attached) attached = given.substr(name.size()+1);
+					found = true;
 				}
-			}
-			for (int j=0; j<_optlist.size(); j++){
-				char sname = (_optlist[j]._sname != "")? 
-					_optlist[j]._sname[1] : '\0';
-				std::string lname = _optlist[j]._lname;
-				
-				if (_optlist[j]._action == Action::Version){
-					if (contains(given, sname, true) || given == lname)
-						print_version = j;
+				else if (name.size() == given.size()){
+					if (arg._action == Action::Help) help_index = i;
+					else if (arg._action == Action::Version) print_version = lidx;
+					else store_flag(arg, opt[lidx]);
+					found = true;
 				}
-				if (_optlist[j]._action != Action::Store) continue;
-				
-				// Bool Flags
-				if (_optlist[j]._valtype == ValType::Bool) continue;
-				// Other Flags
-				if (contains(given, sname)){
-					// Short form concatenation
-					if (_optlist[j]._nargs != 1 && _optlist[j]._nargs != -1)
-						error(_optlist[j].error(2));
-					std::string temp = given.substr(given.find(sname)+1);
-					
-					int setresult = _optlist[j].set(temp, _has_digit_opt, false);
-					if (setresult == 1)
-						error(_optlist[j].error(3, temp));
-					
-					char *ending;
-					if (_optlist[j]._valtype == ValType::Int){
-						int value = strtol(temp.c_str(), &ending, 10);
-						if (std::string(ending) != "" || temp == "")
-							error(_optlist[j].error(1, temp));
-					}
-					else if (_optlist[j]._valtype == ValType::Float){
-						double value = strtod(temp.c_str(), &ending);
-						if (std::string(ending) != "" || temp == "")
-							error(_optlist[j].error(1, temp));
-					}
-					
-					given = given.substr(0, given.find(sname));
-					given += sname;
-					if (_optlist[j]._valtype == ValType::String){
-						if (help_index == i){
-							for (int k=0; k<_helpargs.size(); k++){
-								char h_sname = (_helpargs[k]._sname != "")? 
-									_helpargs[k]._sname[1] : '\0';
-								std::string h_lname = _helpargs[k]._lname;
-
-								if (contains(_optlist[j]._val.back(), h_sname, true) && !contains(given, h_sname, true)){
-									help_index = -1;
-								}
-							}
-						}
+			}
+			else if (given.size() > 1 && given[1] != '-'){
+				// Short form: flags are stored as the cluster is read, and the
+				// first optarg that takes values ends it
+				for (int k=1; k<given.size(); k++){
+					int idx = _shortidx[(unsigned char)given[k]];
+					if (idx < 0){
+						if (found) unrecognized.append(" ").append(given);
+						break;
 					}
-
 					found = true;
+					const Argument& arg = _optlist[idx];
+					if (arg._valtype != ValType::Bool){
+						j = idx;
+						has_attached = (k+1 < given.size());
+						if (has_attached) attached = given.substr(k+1);
+						break;
+					}
+					if (arg._action == Action::Help) help_index = i;
+					else if (arg._action == Action::Version) print_version = idx;
+					else store_flag(arg, opt[idx]);
 				}
-				else if (find_arg(_optlist[j], given)){
-					// Lone argument OR long form concatenation
-					if (_optlist[j]._nargs == 1 || _optlist[j]._more_nargs == '?'){
-						// One narg argument
-						std::string temp = (lname.size()>1 && lname[1] == '-')? given.substr(given.find('=')+1) : given;
-						if (given == temp){
-							// Lone long form
-							if (i+1 >= _nargs){
-								if (_optlist[j]._more_nargs == '?'){
-									_optlist[j]._val = _optlist[j]._const;
-									_optlist[j]._found = true;
-								}
-								else
-									error(_optlist[j].error(2));
-							}
-							else{
-								shift = 2;
-								int setresult = _optlist[j]
-									.set(_args[i+1], _has_digit_opt);
-								if (setresult == 1)
-									error(_optlist[j].error(3, _args[i+1]));
-								else if (setresult == 2){
-									if (_optlist[j]._more_nargs != '?')
-										error(_optlist[j].error(2));
-									else shift = 1;
-								}
-								char *ending;
-								if (_optlist[j]._valtype == ValType::Int){
-									int value = strtol(_args[i+1].c_str(), &ending, 10);
-									if (std::string(ending) != "" || _args[i+1] == "")
-										error(_optlist[j].error(1, _args[i+1]));
-								}
-								else if (_optlist[j]._valtype == ValType::Float){
-									double value = strtod(_args[i+1].c_str(), &ending);
-									if (std::string(ending) != "" || _args[i+1] == "")
-										error(_optlist[j].error(1, _args[i+1]));
-								}
-					
-							}
-						}
-						else{
-							int setresult = _optlist[j].set(temp, _has_digit_opt, false);
-							if (setresult == 1)
-								error(_optlist[j].error(3, temp));
-							
-							char *ending;
-							if (_optlist[j]._valtype == ValType::Int){
-								int value = strtol(temp.c_str(), &ending, 10);
-								if (std::string(ending) != "" || temp == "")
-									error(_optlist[j].error(1, temp));
-							}
-							else if (_optlist[j]._valtype == ValType::Float){
-								double value = strtod(temp.c_str(), &ending);
-								if (std::string(ending) != "" || temp == "")
-									error(_optlist[j].error(1, temp));
-							}
+			}
+			
+			if (j >= 0 && has_attached){
+				// Concatenated value (-n5, --num=5)
+				if (_optlist[j]._nargs != 1 && _optlist[j]._nargs != -1)
+					return result.fail(this, _optlist[j].error(2));
+				int setresult = _optlist[j].set(opt[j], attached, _has_digit_opt, false);
+				if (setresult == 1 || setresult == 3)
+					return result.fail(this, _optlist[j].error(setresult, attached));
+			}
+			else if (j >= 0){
+				// Values given in the following tokens
+				if (_optlist[j]._nargs == 1 || _optlist[j]._more_nargs == '?'){
+					if (i+1 >= nargs){
+						if (_optlist[j]._more_nargs == '?'){
+							opt[j].val = _optlist[j]._constval;
+							opt[j].found = true;
 						}
+						else
+							return result.fail(this, _optlist[j].error(2));
 					}
 					else{
-						// Arguments with >1 nargs
-						if (_optlist[j]._more_nargs == '\0'){
-							if (i+_optlist[j]._nargs >= _nargs)
-								error(_optlist[j].error(2));
-							shift = _optlist[j]._nargs + 1;
-							for (int k=1; k<=_optlist[j]._nargs; k++){
-								int setresult = _optlist[j].set(_args[i+k], _has_digit_opt);
-								if (setresult == 1)
-									error(_optlist[j].error(3, _args[i+k]));
-								else if (setresult == 2)
-									error(_optlist[j].error(2));
-								
-								char *ending;
-								if (_optlist[j]._valtype == ValType::Int){
-									int value = strtol(_args[i+k].c_str(), &ending, 10);
-									if (std::string(ending) != "" || _args[i+k] == "")
-										error(_optlist[j].error(1, _args[i+k]));
-								}
-								else if (_optlist[j]._valtype == ValType::Float){
-									double value = strtod(_args[i+k].c_str(), &ending);
-									if (std::string(ending) != "" || _args[i+k] == "")
-										error(_optlist[j].error(1, _args[i+k]));
-								}
-							}
-						}
-						else if (_optlist[j]._more_nargs == '*' || _optlist[j]._more_nargs == '+'){
-							std::string temp = (lname.size()>1 && lname[1] == '-')? given.substr(given.find('=')+1) : given;
-							if (given == temp){
-								int captured = 0;
-								for (int k=i+1; k<_nargs; k++){
-									int setresult = _optlist[j].set(_args[k], _has_digit_opt);
-									if (setresult == 1)
-										error(_optlist[j].error(3, _args[k]));
-									else if (setresult == 2)
-										break;
-									captured++;
-									
-									char *ending;
-									if (_optlist[j]._valtype == ValType::Int){
-										int value = strtol(_args[k].c_str(), &ending, 10);
-										if (std::string(ending) != "" || _args[k] == "")
-											error(_optlist[j].error(1, _args[k]));
-									}
-									else if (_optlist[j]._valtype == ValType::Float){
-										double value = strtod(_args[k].c_str(), &ending);
-										if (std::string(ending) != "" || _args[k] == "")
-											error(_optlist[j].error(1, _args[k]));
-									}
-								}
-								if (captured == 0){
-									if (_optlist[j]._more_nargs == '+')
-										error(_optlist[j].error(2));
-									_optlist[j]._found = true;
-								}
-								shift = captured + 1;
-							}
-							else{
-								int setresult = _optlist[j].set(temp, _has_digit_opt, false);
-								if (setresult == 1)
-									error(_optlist[j].error(3, temp));
-								
-								char *ending;
-								if (_optlist[j]._valtype == ValType::Int){
-									int value = strtol(temp.c_str(), &ending, 10);
-									if (std::string(ending) != "" || temp == "")
-										error(_optlist[j].error(1, temp));
-								}
-								else if (_optlist[j]._valtype == ValType::Float){
-									double value = strtod(temp.c_str(), &ending);
-									if (std::string(ending) != "" || temp == "")
-										error(_optlist[j].error(1, temp));
-								}
-							}
-						}
-						else if (_optlist[j]._more_nargs == '.'){
-							std::string temp = (lname.size()>1 && lname[1] == '-')? given.substr(given.find('=')+1) : given;
-							if (given == temp){
-								int captured = 0;
-								for (int k=i+1; k<_nargs; k++){
-									int setresult = _optlist[j].set(_args[k], _has_digit_opt, false);
-									if (setresult == 1)
-										error(_optlist[j].error(3, _args[k]));
-									captured++;
-									
-									char *ending;
-									if (_optlist[j]._valtype == ValType::Int){
-										int value = strtol(_args[k].c_str(), &ending, 10);
-										if (std::string(ending) != "" || _args[k] == "")
-											error(_optlist[j].error(1, _args[k]));
-									}
-									else if (_optlist[j]._valtype == ValType::Float){
-										double value = strtod(_args[k].c_str(), &ending);
-										if (std::string(ending) != "" || _args[k] == "")
-											error(_optlist[j].error(1, _args[k]));
-									}
-								}
-								if (captured == 0) _optlist[j]._found = true;
-								shift = captured + 1;
-							}
-							else{
-								int setresult = _optlist[j].set(temp, _has_digit_opt, false);
-								if (setresult == 1)
-									error(_optlist[j].error(3, temp));
-								
-								char *ending;
-								if (_optlist[j]._valtype == ValType::Int){
-									int value = strtol(temp.c_str(), &ending, 10);
-									if (std::string(ending) != "" || temp == "")
-										error(_optlist[j].error(1, temp));
-								}
-								else if (_optlist[j]._valtype == ValType::Float){
-									double value = strtod(temp.c_str(), &ending);
-									if (std::string(ending) != "" || temp == "")
-										error(_optlist[j].error(1, temp));
-								}
-							}
+						shift = 2;
+						int setresult = _optlist[j].set(opt[j], argv[i+1], _has_digit_opt);
+						if (setresult == 1 || setresult == 3)
+							return result.fail(this, _optlist[j].error(setresult, argv[i+1]));
+						else if (setresult == 2){
+							if (_optlist[j]._more_nargs != '?')
+								return result.fail(this, _optlist[j].error(2));
+							else shift = 1;
 						}
 					}
-					found = true;
 				}
-			}
-			// Boolean Args
-			for (int j=0; j<flags.size(); j++){
-				char sname = (flags[j]->_sname != "")? flags[j]->_sname[1] : '\0';
-				std::string lname = flags[j]->_lname;
-				
-				if (contains(given, sname, true) || given == lname){
-					if (flags[j]->_action == Action::Store){
-						if (!flags[j]->_has_default || (flags[j]->_has_default && flags[j]->_def[0] == FALSE))
-							flags[j]->set(TRUE, _has_digit_opt);
-						else
-							flags[j]->set(FALSE, _has_digit_opt);
+				else if (_optlist[j]._more_nargs == '\0'){
+					// Arguments with >1 nargs
+					if (i+_optlist[j]._nargs >= nargs)
+						return result.fail(this, _optlist[j].error(2));
+					shift = _optlist[j]._nargs + 1;
+					for (int k=1; k<=_optlist[j]._nargs; k++){
+						int setresult = _optlist[j].set(opt[j], argv[i+k], _has_digit_opt);
+						if (setresult == 1 || setresult == 3)
+							return result.fail(this, _optlist[j].error(setresult, argv[i+k]));
+						else if (setresult == 2)
+							return result.fail(this, _optlist[j].error(2));
 					}
-					else if (flags[j]->_action == Action::StoreConst){
-						flags[j]->_val = flags[j]->_const;
-						flags[j]->_found = true;
+				}
+				else if (_optlist[j]._more_nargs == '*' || _optlist[j]._more_nargs == '+'){
+					int captured = 0;
+					for (int k=i+1; k<nargs; k++){
+						int setresult = _optlist[j].set(opt[j], argv[k], _has_digit_opt);
+						if (setresult == 1 || setresult == 3)
+							return result.fail(this, _optlist[j].error(setresult, argv[k]));
+						else if (setresult == 2)
+							break;
+						captured++;
 					}
-					else if (flags[j]->_action == Action::Count && given == lname){
-						flags[j]->_val[0] = std::to_string(strtol(flags[j]->_val[0].c_str(), nullptr, 10)+1);
-						flags[j]->_found = true;
+					if (captured == 0){
+						if (_optlist[j]._more_nargs == '+')
+							return result.fail(this, _optlist[j].error(2));
+						opt[j].found = true;
 					}
-					found = true;
+					shift = captured + 1;
+				}
+				else if (_optlist[j]._more_nargs == '.'){
+					std::string_view bad;
+					int setresult = _optlist[j].set(opt[j], argv+i+1, end, bad);
+					if (setresult == 1 || setresult == 3)
+						return result.fail(this, _optlist[j].error(setresult, bad));
+					shift = nargs - i;
 				}
 			}
+			ARGPARSE_TRACE_EVENT("token", given, {"index", std::to_string(i)},
+					{"kind", !found? "unrecognized" : j < 0? "flags" : has_attached? "attached" : "optarg"},
+					{"match", j >= 0? _optlist[j].get_id() : lidx >= 0? _optlist[lidx].get_id() : ""},
+					{"nargs", j < 0? "" : _optlist[j]._more_nargs? std::string(1, _optlist[j]._more_nargs)
+						: std::to_string(_optlist[j]._nargs)},
+					{"values", std::to_string(j < 0? 0 : has_attached? 1 : shift-1)});
 			if (!found){
 				if (_subparser) others.push_back(given);
-				else unrecognized += " " + given;
-			}
-			if (found && given.size() > 1 && given[1] != '-'){
-				for (int j=1; j<given.size(); j++){
-					bool found_optarg = false;
-					for (int k=0; k<_optlist.size(); k++){
-						if (_optlist[k]._sname.size() > 1 && given[j] == _optlist[k]._sname[1]){
-							found_optarg = true;
-							if (_optlist[k]._action == Action::Count){
-								_optlist[k]._val[0] = std::to_string(strtol(_optlist[k]._val[0].c_str(), nullptr, 10)+1);
-								_optlist[k]._found = true;
-							}
-							break;
-						}
-					}
-					if (!found_optarg){
-						unrecognized += " " + _args[i];
-						break;
-					}
-				}
+				else unrecognized.append(" ").append(given);
 			}
 		}
 	}
+	ARGPARSE_STOP(optargs);
+	ARGPARSE_TRACE_END(optargs);
 	if (help_index>=0){
-		print_help();
-		exit(0);
+		result._status = ParseResult::Status::Help;
+		result._parser = this;
+		return;
 	}
 	if (print_version >= 0){
-		std::cout << _optlist[print_version]._version << std::endl;
-		exit(0);
+		result._status = ParseResult::Status::Version;
+		result._parser = this;
+		result._msg = _optlist[print_version]._version;
+		return;
 	}
 
+	ARGPARSE_TIME(defaults);
 	std::string reqlist = "";
 	for (int i=0; i<_optlist.size(); i++){
-		bool parser_def = args.find(_optlist[i]._dest) != args.end();
+		bool parser_def = (result._found[_optlist[i]._slot] == result._depth);
 		if (_optlist[i]._action == Action::Version || _optlist[i]._action == Action::Help)
 			continue;
-		if (!_optlist[i]._found){
+		if (!opt[i].found){
 			if (_optlist[i]._required){
 				if (reqlist == "")
 					reqlist += _optlist[i].get_id();
@@ -827,253 +1316,208 @@ ArgumentMap ArgumentParser::parse_args(std::vector<std::string> argv){
 					reqlist += ", " + _optlist[i].get_id();
 			}
 			else if (_optlist[i]._has_default && !parser_def){
-				_optlist[i]._val = _optlist[i]._def;
-				_optlist[i]._found = true;
+				opt[i].val = _optlist[i]._defval;
+				opt[i].found = true;
+				ARGPARSE_COUNT(defaults, 1);
 			}
 		}
-		else if (_optlist[i].size() == 0 && _optlist[i]._more_nargs == '?'){
-			_optlist[i]._val = _optlist[i]._const;
-			_optlist[i]._found = true;
+		else if (opt[i].val.size() == 0 && _optlist[i]._more_nargs == '?'){
+			opt[i].val = _optlist[i]._constval;
+			opt[i].found = true;
 		}
 		
-		if (_optlist[i]._found)
-			args[_optlist[i]._dest] = _optlist[i]._val;
+		if (opt[i].found)
+			result.slot(_optlist[i]._slot) = opt[i].val;
 		else if (_none_str != SUPPRESS && !parser_def)
-			args[_optlist[i]._dest] = std::vector<std::string>{_none_str};
+			result.slot(_optlist[i]._slot).assign(_none_str);
 	}
+	ARGPARSE_STOP(defaults);
+	
 	// Positional Arguments
-	int nonreq_fillable = posargs.size() - _req_posargs - _base_req_posargs;
+	ARGPARSE_TIME(posargs);
+	ARGPARSE_COUNT(posargs, posargs.size());
+	ARGPARSE_TRACE_SPAN(posargs, "phase", "posargs");
+	int nonreq_fillable = posargs.size() + (end-tail) - _req_posargs - base_req_posargs;
 	int req_filled = 0;
 	int i=0;
-	for (int j=0; j<posargs.size(); j++){
+	// Adds the tokens after the command to posargs, if they are not passed
+	// on to a subparser (as they would have been scanned, without any --)
+	auto keep_tail = [&](){
+		for (; tail != end; tail++)
+			if (*tail != "--") posargs.push_back(*tail);
+	};
+	// Looks the command in posargs[j] up by its name or an alias, or (unless
+	// abbreviations are disallowed) by a prefix of only one command, and
+	// replaces it by the command's name. Returns false if it is ambiguous
+	auto command = [&](int j){
+		int index = _allow_abbrev? _subparsers.match(posargs[j]) : _subparsers.find(posargs[j]);
+		if (index == -2){
+			result.fail(this, "ambiguous command: " + std::string(posargs[j]) 
+					+ " could match " + _subparsers.matches(posargs[j]));
+			return false;
+		}
+		if (index >= 0) posargs[j] = _subparsers._subparsers[index]._subparser_cmd;
+		return true;
+	};
+	// Hands the tokens after the command in posargs[j] to its subparser
+	// (which parses into the same result), and goes on with the posargs it
+	// leaves to this parser. Returns false if the parse failed
+	auto dispatch = [&](int& j){
+		int index = _subparsers.find(posargs[j]);
+		if (index < 0) return true;
+		const ArgumentParser& parser = _subparsers._subparsers[index];
+		parser.built();
+		result.resize();
+		if (!parser._frozen){
+			result.fail(&parser, "parser must be frozen before parsing", false);
+			return false;
+		}
+		ARGPARSE_TIME(dispatch);
+		ARGPARSE_COUNT(dispatch, 1);
+		ARGPARSE_TRACE_SPAN(dispatch, "dispatch", parser._subparser_cmd);
+		if (j+1 < posargs.size()) keep_tail();
+		const std::string_view* first = posargs.data()+j+1;
+		const std::string_view* last = posargs.data()+posargs.size();
+		if (tail != end){
+			first = tail;
+			last = end;
+			tail = end;
+		}
+		result._depth++;
+		parser.parse_into(result, first, last, _req_posargs - req_filled);
+		result._depth--;
+		if (!result.ok()) return false;
+		j = -1;
+		posargs.clear();
+		for (const auto& str : result._others){
+			if (str.substr(0, 1) == "-")
+				unrecognized.append(" ").append(str);
+			else posargs.push_back(str);
+		}
+		result._others.clear();
+		nonreq_fillable = posargs.size() - _req_posargs - base_req_posargs - req_filled;
+		return true;
+	};
+	for (int j=0; ; j++){
+		if (j == posargs.size()) keep_tail();
+		if (j >= posargs.size()) break;
+		ARGPARSE_TRACE_EVENT("posarg", posargs[j], {"index", std::to_string(j)}, 
+				{"arg", i < _arglist.size()? _arglist[i].get_id() : ""},
+				{"fillable", std::to_string(nonreq_fillable)});
 		if (i >= _arglist.size()){
 			if (_subparser) others.push_back(posargs[j]);
 			else{
-				unrecognized += " " + posargs[j];
+				unrecognized.append(" ").append(posargs[j]);
 				i++;
 			}
 			continue;
 		}
+		if (_arglist[i]._more_nargs == '.'){
+			std::string_view bad;
+			int setresult = _arglist[i].set(pos[i], posargs.data()+j, posargs.data()+posargs.size(), bad);
+			if (setresult == 1 || setresult == 3)
+				return result.fail(this, _arglist[i].error(setresult, bad));
+			result.slot(_arglist[i]._slot) = pos[i].val;
+			j = posargs.size();
+			i++;
+			continue;
+		}
 		if (_arglist[i]._required){
 			if (_arglist[i]._more_nargs == '\0'){
-				if (_arglist[i]._valtype == ValType::Int){
-					char *ending;
-					int value = strtol(posargs[j].c_str(), &ending, 10);
-					if (std::string(ending) != "" || posargs[j] == "")
-						error(_arglist[i].error(1, posargs[j]));
-				}
-				else if (_arglist[i]._valtype == ValType::Float){
-					char *ending;
-					double value = strtod(posargs[j].c_str(), &ending);
-					if (std::string(ending) != "" || posargs[j] == "")
-						error(_arglist[i].error(1, posargs[j]));
-				}
-				int setresult = _arglist[i].set(posargs[j], _has_digit_opt);
-				if (setresult == 1)
-					error(_arglist[i].error(3, posargs[j]));
+				if (_arglist[i]._subparser && !command(j)) return;
+				int setresult = _arglist[i].set(pos[i], posargs[j], _has_digit_opt);
+				if (setresult == 1 || setresult == 3)
+					return result.fail(this, _arglist[i].error(setresult, posargs[j]));
 				req_filled++;
 				if (_arglist[i]._dest != "")
-					args[_arglist[i]._dest] = _arglist[i]._val;
+					result.slot(_arglist[i]._slot) = pos[i].val;
 				
-				if (_arglist[i]._subparser){
-					for (auto& parser : _subparsers._subparsers){
-						if (parser._subparser_cmd == _arglist[i]._val[0]){
-							parser._base_req_posargs = _req_posargs - req_filled;
-							auto leftovers = parser.parse_args(
-								std::vector<std::string>(posargs.begin()+j+1, posargs.end())
-							);
-							for (const auto& it : leftovers)
-								if (it.first != SUPPRESS)
-									args[it.first] = it.second;
-							j = -1;
-							posargs.clear();
-							for (const auto& str : leftovers[SUPPRESS]){
-								if (str[0] == '-')
-									unrecognized += " " + str;
-								else posargs.push_back(str);
-							}
-							nonreq_fillable = posargs.size() - _req_posargs - _base_req_posargs - req_filled;
-						}
-					}
-				}
+				if (_arglist[i]._subparser && !dispatch(j)) return;
 				i++;
 			}
 			else{//_more_nargs == '+'
-				if (_arglist[i].size() == 0){
-					if (_arglist[i]._valtype == ValType::Int){
-						char *ending;
-						int value = strtol(posargs[j].c_str(), &ending, 10);
-						if (std::string(ending) != "" || posargs[j] == "")
-							error(_arglist[i].error(1, posargs[j]));
-					}
-					else if (_arglist[i]._valtype == ValType::Float){
-						char *ending;
-						double value = strtod(posargs[j].c_str(), &ending);
-						if (std::string(ending) != "" || posargs[j] == "")
-							error(_arglist[i].error(1, posargs[j]));
-					}
-					int setresult = _arglist[i].set(posargs[j], _has_digit_opt);
-					if (setresult == 1)
-						error(_arglist[i].error(3, posargs[j]));
-					if (_arglist[i]._dest != "") args[_arglist[i]._dest] = _arglist[i]._val;
+				if (pos[i].val.size() == 0){
+					int setresult = _arglist[i].set(pos[i], posargs[j], _has_digit_opt);
+					if (setresult == 1 || setresult == 3)
+						return result.fail(this, _arglist[i].error(setresult, posargs[j]));
+					store_values(_arglist[i], pos[i], result);
 					req_filled++;
 				}
 				else if (nonreq_fillable > 0){
-					if (_arglist[i]._valtype == ValType::Int){
-						char *ending;
-						int value = strtol(posargs[j].c_str(), &ending, 10);
-						if (std::string(ending) != "" || posargs[j] == "")
-							error(_arglist[i].error(1, posargs[j]));
-					}
-					else if (_arglist[i]._valtype == ValType::Float){
-						char *ending;
-						double value = strtod(posargs[j].c_str(), &ending);
-						if (std::string(ending) != "" || posargs[j] == "")
-							error(_arglist[i].error(1, posargs[j]));
-					}
-					int setresult = _arglist[i].set(posargs[j], _has_digit_opt);
-					if (setresult == 1)
-						error(_arglist[i].error(3, posargs[j]));
-					if (_arglist[i]._dest != "") args[_arglist[i]._dest] = _arglist[i]._val;
+					int setresult = _arglist[i].set(pos[i], posargs[j], _has_digit_opt);
+					if (setresult == 1 || setresult == 3)
+						return result.fail(this, _arglist[i].error(setresult, posargs[j]));
+					store_values(_arglist[i], pos[i], result);
 					nonreq_fillable--;
 				}
 				else{
+					ARGPARSE_TRACE_EVENT("backtrack", _arglist[i].get_id(), {"token", std::to_string(j)});
 					i++;
 					j--;
 				}
 			}
 		}
 		else{
-			if (first_collection >= 0){
-				if (i > first_collection){
+			if (_first_collection >= 0){
+				if (i > _first_collection){
 					if (_none_str != SUPPRESS && _arglist[i]._dest != "")
-						args[_arglist[i]._dest] = std::vector<std::string>{_none_str};
+						result.slot(_arglist[i]._slot).assign(_none_str);
+					ARGPARSE_TRACE_EVENT("backtrack", _arglist[i].get_id(), {"token", std::to_string(j)});
 					i++;
 					j--;
 				}
-				else if (i == first_collection){//_more_nargs == '*'
+				else if (i == _first_collection){//_more_nargs == '*'
 					if (nonreq_fillable > 0){
-						if (_arglist[i]._valtype == ValType::Int){
-							char *ending;
-							int value = strtol(posargs[j].c_str(), &ending, 10);
-							if (std::string(ending) != "" || posargs[j] == "")
-								error(_arglist[i].error(1, posargs[j]));
-						}
-						else if (_arglist[i]._valtype == ValType::Float){
-							char *ending;
-							double value = strtod(posargs[j].c_str(), &ending);
-							if (std::string(ending) != "" || posargs[j] == "")
-								error(_arglist[i].error(1, posargs[j]));
-						}
-						int setresult = _arglist[i].set(posargs[j], _has_digit_opt);
-						if (setresult == 1)
-							error(_arglist[i].error(3, posargs[j]));
-						if (_arglist[i]._dest != "") args[_arglist[i]._dest] = _arglist[i]._val;
+						int setresult = _arglist[i].set(pos[i], posargs[j], _has_digit_opt);
+						if (setresult == 1 || setresult == 3)
+							return result.fail(this, _arglist[i].error(setresult, posargs[j]));
+						store_values(_arglist[i], pos[i], result);
 						nonreq_fillable--;
 					}
 					else{
-						if (_arglist[i].size() == 0 && _none_str != SUPPRESS)
-							args[_arglist[i]._dest] = std::vector<std::string>{_none_str};
+						if (pos[i].val.size() == 0 && _none_str != SUPPRESS)
+							result.slot(_arglist[i]._slot).assign(_none_str);
+						ARGPARSE_TRACE_EVENT("backtrack", _arglist[i].get_id(), {"token", std::to_string(j)});
 						i++;
 						j--;
 					}
 				}
 				else if (nonreq_fillable > 0){
-					if (_arglist[i]._valtype == ValType::Int){
-						char *ending;
-						int value = strtol(posargs[j].c_str(), &ending, 10);
-						if (std::string(ending) != "" || posargs[j] == "")
-							error(_arglist[i].error(1, posargs[j]));
-					}
-					else if (_arglist[i]._valtype == ValType::Float){
-						char *ending;
-						double value = strtod(posargs[j].c_str(), &ending);
-						if (std::string(ending) != "" || posargs[j] == "")
-							error(_arglist[i].error(1, posargs[j]));
-					}
-					int setresult = _arglist[i].set(posargs[j], _has_digit_opt);
-					if (setresult == 1)
-						error(_arglist[i].error(3, posargs[j]));
+					if (_arglist[i]._subparser && !command(j)) return;
+					int setresult = _arglist[i].set(pos[i], posargs[j], _has_digit_opt);
+					if (setresult == 1 || setresult == 3)
+						return result.fail(this, _arglist[i].error(setresult, posargs[j]));
 					if (_arglist[i]._dest != "") 
-						args[_arglist[i]._dest] = _arglist[i]._val;
+						result.slot(_arglist[i]._slot) = pos[i].val;
 					nonreq_fillable--;
 					
-					if (_arglist[i]._subparser){
-						for (auto& parser : _subparsers._subparsers){
-							if (parser._subparser_cmd == _arglist[i]._val[0]){
-								parser._args = std::vector<std::string>(posargs.begin()+j+1, posargs.end());
-								parser._nargs = parser._args.size();
-								parser._base_req_posargs = _req_posargs - req_filled;
-								auto leftovers = parser.parse_args();
-								for (const auto& it : leftovers)
-									if (it.first != SUPPRESS)
-										args[it.first] = it.second;
-								j = -1;
-								posargs.clear();
-								for (const auto& str : leftovers[SUPPRESS]){
-									if (str[0] == '-')
-										unrecognized += " " + str;
-									else posargs.push_back(str);
-								}
-								nonreq_fillable = posargs.size() - _req_posargs - _base_req_posargs - req_filled;
-							}
-						}
-					}
+					if (_arglist[i]._subparser && !dispatch(j)) return;
 					i++;
 				}
 				else{
 					if (_none_str != SUPPRESS && _arglist[i]._dest != "")
-						args[_arglist[i]._dest] = std::vector<std::string>{_none_str};
+						result.slot(_arglist[i]._slot).assign(_none_str);
+					ARGPARSE_TRACE_EVENT("backtrack", _arglist[i].get_id(), {"token", std::to_string(j)});
 					i++;
 					j--;
 				}
 			}
 			else{
 				if (nonreq_fillable > 0){
-					if (_arglist[i]._valtype == ValType::Int){
-						char *ending;
-						int value = strtol(posargs[j].c_str(), &ending, 10);
-						if (std::string(ending) != "" || posargs[j] == "")
-							error(_arglist[i].error(1, posargs[j]));
-					}
-					else if (_arglist[i]._valtype == ValType::Float){
-						char *ending;
-						double value = strtod(posargs[j].c_str(), &ending);
-						if (std::string(ending) != "" || posargs[j] == "")
-							error(_arglist[i].error(1, posargs[j]));
-					}
-					int setresult = _arglist[i].set(posargs[j], _has_digit_opt);
-					if (setresult == 1)
-						error(_arglist[i].error(3, posargs[j]));
-					if (_arglist[i]._dest != "") args[_arglist[i]._dest] = _arglist[i]._val;
+					if (_arglist[i]._subparser && !command(j)) return;
+					int setresult = _arglist[i].set(pos[i], posargs[j], _has_digit_opt);
+					if (setresult == 1 || setresult == 3)
+						return result.fail(this, _arglist[i].error(setresult, posargs[j]));
+					store_values(_arglist[i], pos[i], result);
 					nonreq_fillable--;
 					
-					if (_arglist[i]._subparser){
-						for (auto& parser : _subparsers._subparsers){
-							if (parser._subparser_cmd == _arglist[i]._val[0]){
-								parser._args = std::vector<std::string>(posargs.begin()+j+1, posargs.end());
-								parser._nargs = parser._args.size();
-								parser._base_req_posargs = _req_posargs - req_filled;
-								auto leftovers = parser.parse_args();
-								for (const auto& it : leftovers)
-									if (it.first != SUPPRESS)
-										args[it.first] = it.second;
-								j = -1;
-								posargs.clear();
-								for (const auto& str : leftovers[SUPPRESS]){
-									if (str[0] == '-')
-										unrecognized += " " + str;
-									else posargs.push_back(str);
-								}
-								nonreq_fillable = posargs.size() - _req_posargs - _base_req_posargs - req_filled;
-							}
-						}
-					}
+					if (_arglist[i]._subparser && !dispatch(j)) return;
 					i++;
 				}
 				else{
 					if (_none_str != SUPPRESS && _arglist[i]._dest != "")
-						args[_arglist[i]._dest] = std::vector<std::string>{_none_str};
+						result.slot(_arglist[i]._slot).assign(_none_str);
+					ARGPARSE_TRACE_EVENT("backtrack", _arglist[i].get_id(), {"token", std::to_string(j)});
 					i++;
 					j--;
 				}
@@ -1081,22 +1525,25 @@ ArgumentMap ArgumentParser::parse_args(std::vector<std::string> argv){
 		}
 	}
 	while (i < _arglist.size()){
-		if (!_arglist[i]._found && _arglist[i]._required)
+		if (!pos[i].found && _arglist[i]._required)
 			reqlist += (reqlist == ""? "" : ", ") + _arglist[i]._metavar[0];
+		if (!pos[i].found && _arglist[i]._more_nargs == '.')
+			result.slot(_arglist[i]._slot) = pos[i].val;
 		i++;
 	}
-	if (_subparser) args[SUPPRESS] = others;
+	if (_subparser) result._others = others;
 	// Final Error Checking
-	if (reqlist != "") error("the following arguments are required: " + reqlist);
+	if (reqlist != "") return result.fail(this, "the following arguments are required: " + reqlist);
 	if (unrecognized != "")
-		error("unrecognized arguments:" + unrecognized);
+		return result.fail(this, "unrecognized arguments:" + std::string(unrecognized));
 
-	return args;
+	result._parser = this;
 }
 
 // Private Helpers {{{2
 void ArgumentParser::check_conflict(const Argument& arg, ArgType type){
 	std::string sname = arg._sname, lname = arg._lname;
+	_frozen = false;
 	if (type == ArgType::Optarg){
 		if (sname == "" && lname == "")
 			error("option string(s) must be provided");
@@ -1128,19 +1575,25 @@ void ArgumentParser::check_conflict(const Argument& arg, ArgType type){
 						+ "must end with at least one alphanumeric character");
 		}
 
+		// The optargs holding either name are found in _optnames. Resolved
+		// optargs left without names stay in _optlist until the next freeze
+		auto sit = (sname == "")? _optnames.end() : _optnames.find(sname);
+		auto lit = (lname == "")? _optnames.end() : _optnames.find(lname);
 		std::string conflicts = "";
-		for (int i=0; i<_optlist.size(); i++){
-			if (sname != "" && sname == _optlist[i]._sname){
-				conflicts += (conflicts == ""? "" : ", ") + sname;
-				if (_resolve) _optlist[i]._sname = "";
-			}
-			if (lname != "" && lname == _optlist[i]._lname){
-				conflicts += (conflicts == ""? "" : ", ") + lname;
-				if (_resolve) _optlist[i]._lname = "";
+		if (sit != _optnames.end()) conflicts = sname;
+		if (lit != _optnames.end()){
+			if (conflicts == "") conflicts = lname;
+			else if (lit->second < sit->second) conflicts = lname + ", " + sname;
+			else conflicts += ", " + lname;
+		}
+		if (_resolve){
+			if (sit != _optnames.end()){
+				_optlist[sit->second]._sname = "";
+				_optnames.erase(sit);
 			}
-			if (_optlist[i]._sname == "" && _optlist[i]._lname == ""){
-				_optlist.erase(_optlist.begin()+i);
-				i--;
+			if (lit != _optnames.end()){
+				_optlist[lit->second]._lname = "";
+				_optnames.erase(lit);
 			}
 		}
 		if (!_resolve && conflicts != ""){
@@ -1148,183 +1601,621 @@ void ArgumentParser::check_conflict(const Argument& arg, ArgType type){
 				+ ": conflicting option strings: " + conflicts;
 			error(conflicts);
 		}
+		// The arg is added at the end of _optlist
+		if (sname != "") _optnames[sname] = _optlist.size();
+		if (lname != "") _optnames[lname] = _optlist.size();
 	}
 }
 
+void ArgumentParser::load_names(){
+	// Drops the optargs that lost all their names to later ones and indexes
+	// the names of the rest
+	_optlist.erase(std::remove_if(_optlist.begin(), _optlist.end(), [](const Argument& arg){
+		return arg._sname == "" && arg._lname == "";
+	}), _optlist.end());
+	_optnames.clear();
+	for (int i=0; i<_optlist.size(); i++){
+		if (_optlist[i]._sname != "") _optnames[_optlist[i]._sname] = i;
+		if (_optlist[i]._lname != "") _optnames[_optlist[i]._lname] = i;
+	}
+}
+
+std::string ArgumentParser::field_name(std::string name) const{
+	if (name.substr(0, 1) == "-") return name;
+	std::replace(name.begin(), name.end(), '_', '-');
+	return "--" + name;
+}
+
 inline bool ArgumentParser::valid_value(std::string val) const{
 	return !(val[0] == '-' && val.size() > 1 && (!isdigit(val[1]) || (isdigit(val[1]) && _has_digit_opt)));
 }
 
-void ArgumentParser::load_helpstring(){
-	_opthelp = "";
-	_arghelp = "";
-	_subhelp = "";
-	_usage = "usage: " + _prog;
-	_usage_line_len = _usage.size(); 
-	_preusage_len = _usage_line_len;
-	
-	if (_add_help && !_added_help){
-		Argument arg(ArgType::Optarg, ValType::Bool, "-h", "--help");
-		arg.help("show this help message and exit");
-		arg._action = Action::Help;
-		check_conflict(arg, ArgType::Optarg);
-		_helpargs.push_back(arg);
-		_optlist.insert(_optlist.begin(), arg);
-		_added_help = true;
-	}
+void ArgumentParser::load_helpstring() const{
+	// Renders into _helpcache (the caller holds its lock)
+	ARGPARSE_TIME(help);
+	ARGPARSE_COUNT(help, _optlist.size() + _arglist.size());
+	std::string opthelp, arghelp, subhelp;
+	std::string usage = _override_usage? _usage : "usage: " + _prog;
+	int usage_line_len = usage.size(), preusage_len = usage_line_len;
+	int help_indent = 0;
+	bool multiline_usage = false;
 
 	for (const auto& arg : _optlist){
 		int temp = arg.get_help_id(_format).size();
-		if (temp+2 > _help_indent) _help_indent 
+		if (temp+2 > help_indent) help_indent 
 			= (temp+2>HELP_INDENT_MAX)? HELP_INDENT_MAX : temp+2;
 	}
 	for (const auto& arg : _arglist){
 		int temp = arg.get_help_id(_format).size();
-		if (temp+2 > _help_indent) _help_indent 
+		if (temp+2 > help_indent) help_indent 
 			= (temp+2>HELP_INDENT_MAX)? HELP_INDENT_MAX : temp+2;
 		if (arg._subparser){
 			for (const auto& parser : _subparsers._subparsers){
-				temp = std::string("    " + parser._subparser_cmd).size();
-				if (temp+2 > _help_indent) _help_indent
+				temp = std::string("    " + parser.get_subparser_name()).size();
+				if (temp+2 > help_indent) help_indent
 					= (temp+2>HELP_INDENT_MAX)? HELP_INDENT_MAX : temp+2;
 			}
 		}
 	}
 	
-	if (_optlist.size() != 0) _opthelp += "options:";
+	if (_optlist.size() != 0) opthelp += "options:";
 	for (auto& arg : _optlist){
 		if (arg._help == SUPPRESS) continue;
-		_opthelp += "\n" + arg.get_help(_linecap, _help_indent, _format);
+		opthelp += "\n" + arg.get_help(_linecap, help_indent, _format);
 		if (_override_usage) continue;
-		std::string usage = arg.get_usage(_format);
-		if (_usage_line_len + usage.size() + 1 <= _linecap){
-			_usage += " " + usage;
-			_usage_line_len += usage.size() + 1;
+		std::string argusage = arg.get_usage(_format);
+		if (usage_line_len + argusage.size() + 1 <= _linecap){
+			usage += " " + argusage;
+			usage_line_len += argusage.size() + 1;
 		}
 		else{
-			_usage += '\n';
-			_multiline_usage = true;
-			for (int i=0; i<_preusage_len; i++) _usage += ' ';
-			_usage += " " + usage;
-			_usage_line_len = _preusage_len + usage.size() + 1;
+			usage += '\n';
+			multiline_usage = true;
+			for (int i=0; i<preusage_len; i++) usage += ' ';
+			usage += " " + argusage;
+			usage_line_len = preusage_len + argusage.size() + 1;
 		}
 	}
 
-	bool get_sub_prog = _subparsers.valid();
-	std::string sub_prog = "";
-	
 	if (_arglist.size()-(_subparsers.valid() && _subparsers._title != ""? 1:0)!= 0)
-		_arghelp += "positional arguments:";
+		arghelp += "positional arguments:";
 	for (int i=0; i<_arglist.size(); i++){
 		if (_arglist[i]._help == SUPPRESS) continue;
 
 		if (!_arglist[i]._subparser || (_arglist[i]._subparser && _subparsers._title == "")) 
-			_arghelp += "\n" + _arglist[i].get_help(_linecap, _help_indent, _format);
+			arghelp += "\n" + _arglist[i].get_help(_linecap, help_indent, _format);
 		if (_arglist[i]._subparser && _subparsers._title == ""){
 			for (const auto& parser : _subparsers._subparsers){
 				if (parser._subparser_help == "") continue;
-				_arghelp += "\n" + parser.get_subparser_help(_linecap, _help_indent, _format);
+				arghelp += "\n" + parser.get_subparser_help(_linecap, help_indent, _format);
 			}
 		}
 		if (_override_usage) continue;
-		std::string usage = _arglist[i].get_usage(_format);
-		if (_multiline_usage){
-			_multiline_usage = false;
-			_usage += '\n';
-			for (int i=0; i<_preusage_len; i++) _usage += ' ';
-			_usage += " " + usage;
-			_usage_line_len = _preusage_len + usage.size() + 1;
-		}
-		else if (_usage_line_len + usage.size() + 1 <= _linecap){
-			_usage += " " + usage;
-			_usage_line_len += usage.size() + 1;
-		}
-		else{
-			_usage += '\n';
-			for (int i=0; i<_preusage_len; i++) _usage += ' ';
-			_usage += " " + usage;
-			_usage_line_len = _preusage_len + usage.size() + 1;
+		std::string argusage = _arglist[i].get_usage(_format);
+		if (multiline_usage){
+			multiline_usage = false;
+			usage += '\n';
+			for (int i=0; i<preusage_len; i++) usage += ' ';
+			usage += " " + argusage;
+			usage_line_len = preusage_len + argusage.size() + 1;
 		}
-		
-		if (_arglist[i]._subparser)
-			get_sub_prog = false;
-		else if (get_sub_prog){
-			sub_prog += " " + usage;
+		else if (usage_line_len + argusage.size() + 1 <= _linecap){
+			usage += " " + argusage;
+			usage_line_len += argusage.size() + 1;
 		}
-	}
-	
-	if (_subparsers.valid()){
-		for (auto& parser : _subparsers._subparsers){
-			if (_subparsers._prog != "")
-				parser.prog(_subparsers._prog + " " + parser._subparser_cmd);
-			else parser.prog(_prog + sub_prog + " " + parser._subparser_cmd);
+		else{
+			usage += '\n';
+			for (int i=0; i<preusage_len; i++) usage += ' ';
+			usage += " " + argusage;
+			usage_line_len = preusage_len + argusage.size() + 1;
 		}
 	}
 
 	if (_subparsers.valid() && _subparsers._title != ""){
-		_subhelp += _subparsers._title + ":";
+		subhelp += _subparsers._title + ":";
 		if (_subparsers._desc != "")
-			_subhelp += "\n" + wrap(_subparsers._desc, 1) + "\n";
-		_subhelp += "\n" + _arglist[_subparser_index].get_help(_linecap, _help_indent, _format);
+			subhelp += "\n" + wrap(_subparsers._desc, 1) + "\n";
+		subhelp += "\n" + _arglist[_subparser_index].get_help(_linecap, help_indent, _format);
 		for (const auto& parser : _subparsers._subparsers){
 			if (parser._subparser_help == "") continue;
-			_subhelp += "\n" + parser.get_subparser_help(_linecap, _help_indent, _format);
+			subhelp += "\n" + parser.get_subparser_help(_linecap, help_indent, _format);
+		}
+	}
+	
+	std::string help = usage;
+	if (_desc != "") help += "\n\n" + wrap(_desc);
+	if (arghelp != "") help += "\n\n" + arghelp;
+	if (opthelp != "") help += "\n\n" + opthelp;
+	if (subhelp != "") help += "\n\n" + subhelp;
+	if (_epilog != "") help += "\n\n" + wrap(_epilog);
+	_helpcache.rendered_usage = usage;
+	_helpcache.rendered_help = help;
+	_helpcache.usage = _helpcache.rendered_usage;
+	_helpcache.help = _helpcache.rendered_help;
+}
+
+const ArgumentParser::HelpCache& ArgumentParser::helpstrings() const{
+	if (!_helpcache.valid.load(std::memory_order_acquire)){
+		std::lock_guard<std::mutex> guard(_helpcache.lock);
+		if (!_helpcache.valid.load(std::memory_order_relaxed)){
+			const HelpSnapshot* snapshot = nullptr;
+			for (int i=0; i<_nsnapshots && !snapshot; i++)
+				if (_snapshots[i].prog == _prog && _snapshots[i].format == _format
+						&& _snapshots[i].linecap == _linecap)
+					snapshot = _snapshots + i;
+			if (snapshot){
+				_helpcache.usage = snapshot->usage;
+				_helpcache.help = snapshot->help;
+			}
+			else load_helpstring();
+			_helpcache.valid.store(true, std::memory_order_release);
+		}
+	}
+	return _helpcache;
+}
+
+void ArgumentParser::snapshot_help(std::ostream& out, const std::vector<int>& linecaps){
+	// Renders the help at each linecap (bypassing any precompiled help), and
+	// writes it as C++ string literals, one per line of text
+	const char* formats[] = {"Default", "ArgumentDefaults", "RawDescription",
+		"RawText", "MetavarType"};
+	auto literal = [](std::string_view text){
+		std::string str = "\"";
+		for (char c : text){
+			if (c == '\n') str += "\\n\"\n\t\t\"";
+			else if (c == '"' || c == '\\') str += std::string("\\") + c;
+			else if (c == '\t') str += "\\t";
+			else str += c;
 		}
+		return str + "\"";
+	};
+	int linecap = _linecap;
+	for (int cap : linecaps){
+		_linecap = cap;
+		load_helpstring();
+		out << "\t{" << literal(_prog) << ", argparse::HelpFormatter::" 
+			<< formats[(int)_format] << ", " << cap << ",\n";
+		out << "\t\t" << literal(_helpcache.rendered_usage) << ",\n";
+		out << "\t\t" << literal(_helpcache.rendered_help) << "},\n";
+	}
+	_linecap = linecap;
+	_helpcache.valid = false;
+	for (auto& parser : _subparsers._subparsers) {
+		parser.built();
+		parser.snapshot_help(out, linecaps);
+	}
+}
+
+void ArgumentParser::load_index(){
+	{
+		std::unique_lock<std::shared_mutex> guard(_dests->lock);
+		for (auto* list : {&_optlist, &_arglist}){
+			for (auto& arg : *list){
+				arg._dests = _dests.get();
+				arg._parser = this;
+				arg._slot = _dests->insert(arg._dest);
+				if (arg._slot < 0 || !arg._bind.write) continue;
+				if (_dests->binds.size() <= arg._slot) _dests->binds.resize(arg._slot+1);
+				_dests->binds[arg._slot] = arg._bind;
+			}
+		}
+		_defslots.clear();
+		for (const auto& it : _defaults)
+			_defslots.push_back({_dests->insert(it.first), it.second});
+	}
+	
+	_shortidx.fill(-1);
+	std::vector<std::pair<std::string_view, int>> names;
+	for (int i=0; i<_optlist.size(); i++){
+		if (_optlist[i]._sname.size() > 1)
+			_shortidx[(unsigned char)_optlist[i]._sname[1]] = i;
+		if (_optlist[i]._lname != "")
+			names.push_back({_optlist[i]._lname, i});
+	}
+	size_t size = 1;
+	while (size < 2*names.size()) size *= 2;
+	_longidx.assign(size, {0, -1});
+	for (const auto& it : names){
+		size_t hash = std::hash<std::string_view>()(it.first), e = hash & (size-1);
+		while (_longidx[e].second >= 0) e = (e+1) & (size-1);
+		_longidx[e] = {hash, it.second};
+	}
+	std::sort(names.begin(), names.end());
+	_longtrie.clear();
+	_longedges.clear();
+	load_trie(names, 0, names.size(), 0);
+}
+
+int ArgumentParser::load_trie(const std::vector<std::pair<std::string_view, int>>& names,
+		int begin, int end, int depth){
+	// Adds the node for the prefix of length depth shared by the (sorted)
+	// names in [begin, end) and its subtree, returning the node's index. The
+	// nodes are numbered depth first so that a lookup reads mostly
+	// consecutive memory
+	int node = _longtrie.size();
+	_longtrie.push_back(TrieNode{-1, -1, 0, 0});
+	if (end - begin == 1) _longtrie[node].unique = names[begin].second;
+	else if (end - begin > 1) _longtrie[node].unique = -2;
+	if (begin < end && names[begin].first.size() == depth){
+		_longtrie[node].exact = names[begin].second;
+		begin++;
+	}
+	
+	int nedges = 0;
+	for (int i=begin; i<end; i++)
+		if (i == begin || names[i].first[depth] != names[i-1].first[depth])
+			nedges++;
+	int first = _longedges.size();
+	_longtrie[node].first = first;
+	_longtrie[node].nedges = nedges;
+	_longedges.resize(first + nedges);
+	for (int e=0; e<nedges; e++){
+		char c = names[begin].first[depth];
+		int next = begin;
+		while (next < end && names[next].first[depth] == c) next++;
+		int child = load_trie(names, begin, next, depth+1);
+		_longedges[first+e] = {c, child};
+		begin = next;
+	}
+	return node;
+}
+
+void ArgumentParser::load_subparser_progs(){
+	if (!_subparsers.valid()) return;
+	std::string sub_prog = "";
+	for (int i=0; i<_arglist.size(); i++){
+		if (_arglist[i]._help == SUPPRESS || _override_usage) continue;
+		if (_arglist[i]._subparser) break;
+		sub_prog += " " + _arglist[i].get_usage(_format);
+	}
+	for (auto& parser : _subparsers._subparsers){
+		if (_subparsers._prog != "")
+			parser.prog(_subparsers._prog + " " + parser._subparser_cmd);
+		else parser.prog(_prog + sub_prog + " " + parser._subparser_cmd);
+	}
+}
+const ArgumentParser& ArgumentParser::built() const{
+	// Lazy subparsers are built (and frozen) by the first caller that needs
+	// them; the others wait on the lock until they are done
+	if (!_factory.build || _factory.built.load(std::memory_order_acquire)) return *this;
+	std::lock_guard<std::mutex> guard(_factory.lock);
+	if (!_factory.built.load(std::memory_order_relaxed)){
+		ArgumentParser& self = const_cast<ArgumentParser&>(*this);
+		_factory.build(self);
+		self.freeze();
+		_factory.built.store(true, std::memory_order_release);
 	}
+	return *this;
+}
+void ArgumentParser::build_all() const{
+	for (const auto& parser : _subparsers._subparsers) parser.built().build_all();
 }
 
-std::vector<std::string> ArgumentParser::read_args_from_files(std::vector<std::string> args){
-	std::vector<std::string> result;
-	for (const auto& str : args){
+std::pmr::vector<std::string_view> ArgumentParser::read_args_from_files(
+		const std::string_view* first, const std::string_view* last, ParseResult& result, 
+		std::pmr::memory_resource* mem) const{
+	// Lines read from files are kept by the result (allocated from mem) so
+	// that they can be viewed like the rest of argv
+	std::pmr::vector<std::string_view> expanded(mem);
+	for (; first != last; first++){
+		std::string_view str = *first;
 		bool found = false;
 		for (const auto& prefix : _fromfile_prefix){
-			if (str[0] == prefix){
+			if (str.substr(0, 1) == std::string_view(&prefix, 1)){
 				found = true;
 				break;
 			}
 		}
-		if (!found) result.push_back(str);
+		if (!found) expanded.push_back(str);
 		else{
-			std::ifstream infile(str.substr(1));
+			std::ifstream infile(std::string(str.substr(1)));
 			if (infile.is_open()){
-				std::vector<std::string> temp;
+				std::pmr::vector<std::string_view> temp(mem);
 				std::string line;
 				while (std::getline(infile, line))
-					temp.push_back(line);
-				temp = read_args_from_files(temp);
-				result.insert(result.end(), temp.begin(), temp.end());
+					temp.push_back(result.keep_line(line, mem));
+				temp = read_args_from_files(temp.data(), temp.data()+temp.size(), result, mem);
+				expanded.insert(expanded.end(), temp.begin(), temp.end());
+			}
+			else{
+				result.fail(this, "error opening file " + std::string(str.substr(1)), false);
+				break;
 			}
-			else error("error opening file " + str.substr(1));
 		}
 	}
-	return result;
+	return expanded;
+}
+
+int ArgumentParser::match_long(std::string_view name) const{
+	// Index in _optlist of the optarg with the given long name, or the only
+	// one it abbreviates (-1 if there is none, -2 if it is ambiguous). Full
+	// names are found in the hash table, which touches less memory than a
+	// walk down the trie
+	size_t hash = std::hash<std::string_view>()(name), mask = _longidx.size()-1;
+	for (size_t e = hash & mask; _longidx[e].second >= 0; e = (e+1) & mask)
+		if (_longidx[e].first == hash && _optlist[_longidx[e].second]._lname == name)
+			return _longidx[e].second;
+	// Only --long options are abbreviated, so that short clusters are not
+	// taken for single-dash long names
+	if (!_allow_abbrev || name.size() < 3 || name.substr(0, 2) != "--") return -1;
+	int node = 0;
+	for (char c : name){
+		const TrieNode& parent = _longtrie[node];
+		node = -1;
+		for (int e=parent.first; e<parent.first+parent.nedges; e++){
+			if (_longedges[e].first == c){
+				node = _longedges[e].second;
+				break;
+			}
+		}
+		if (node < 0) return -1;
+	}
+	return _longtrie[node].unique;
 }
 
-bool ArgumentParser::find_arg(const Argument& arg, std::string given) const{
-	bool equals = (given.find('=') != std::string::npos);
-	bool cond1 = given.size() > 1 && given[1] != '-' 
-		&& given[given.size()-1] == arg._sname[1];
-	bool cond2 = arg._lname != "";
-	bool cond3a = (given.find(arg._lname) == 0 && (given.find('=') == arg._lname.size()));
-	bool cond3b = (given == arg._lname);
-
-	// True if (1) does not begin with '--' and ends with sname[0] OR (2) begins with long form
-	return cond1 || (cond2 && (cond3a || cond3b));
+std::string ArgumentParser::ambiguous_option(std::string_view name) const{
+	std::string matches = "";
+	for (const auto& arg : _optlist)
+		if (arg._lname.compare(0, name.size(), name) == 0)
+			matches += (matches == ""? "" : ", ") + arg._lname;
+	return "ambiguous option: " + std::string(name) + " could match " + matches;
+}
+
+void ArgumentParser::store_flag(const Argument& flag, ParseState::Slot& slot) const{
+	if (flag._action == Action::Store){
+		if (!flag._has_default || (flag._has_default && flag._def[0] == FALSE))
+			flag.set(slot, TRUE, _has_digit_opt);
+		else
+			flag.set(slot, FALSE, _has_digit_opt);
+	}
+	else if (flag._action == Action::StoreConst){
+		slot.val = flag._constval;
+		slot.found = true;
+	}
+	else if (flag._action == Action::Count){
+		// Counts are only kept in native form
+		slot.val.str.clear();
+		slot.val.num[0] = std::get<int>(slot.val.num[0]) + 1;
+		slot.found = true;
+	}
+}
+
+void ArgumentParser::store_values(const Argument& arg, const ParseState::Slot& slot,
+		ParseResult& result) const{
+	// Collections ('+' and '*') gain a value at a time, so only the values
+	// that the result does not have yet are copied into it
+	if (arg._dest == "") return;
+	ParseResult::Values& stored = result.slot(arg._slot);
+	if (slot.val.size() <= 1 || stored.str.size() > slot.val.str.size() 
+			|| stored.num.size() > slot.val.num.size())
+		stored = slot.val;
+	else{
+		stored.str.insert(stored.str.end(), slot.val.str.begin()+stored.str.size(), slot.val.str.end());
+		stored.num.insert(stored.num.end(), slot.val.num.begin()+stored.num.size(), slot.val.num.end());
+	}
 }
 
-bool ArgumentParser::contains(std::string given, char sname, bool flag) const{
-	bool found = (given.find(sname) != std::string::npos);
-	bool cond1 = (given.size() > 1 && given[1] != '-');
-	bool cond2 = given.find(sname) != given.size()-1 || flag;
+void ArgumentParser::push_level(PushParser& push) const{
+	PushParser::Level level;
+	level.parser = this;
+	level.found.assign(_optlist.size(), false);
+	level.missing = level.posargs = level.min_posargs = level.max_posargs = 0;
+	level.pending = -1;
+	level.pending_count = level.pending_min = 0;
+	level.only_posargs = false;
+	for (const auto& arg : _optlist)
+		if (arg._required && arg._action != Action::Help && arg._action != Action::Version)
+			level.missing++;
+	for (const auto& arg : _arglist){
+		// Posargs after a '+' or '*' one leave the maximum unbounded, but
+		// the required ones still add to the minimum
+		if (arg._required) level.min_posargs += (arg._more_nargs == '+'? 1 : arg._nargs);
+		if (level.max_posargs >= 0){
+			if (arg._more_nargs == '\0') level.max_posargs += arg._nargs;
+			else if (arg._more_nargs == '?') level.max_posargs++;
+			else level.max_posargs = -1;
+		}
+		if (arg._subparser) break;
+	}
+	if (_subparsers.valid()) level.max_posargs = -1;
+	push._levels.push_back(level);
+}
+
+void ArgumentParser::push_token(PushParser& push, std::string_view given) const{
+	// Matches one token as the main loop of parse_into() would
+	PushParser::Level& level = push._levels.back();
+	if (_remainder_start >= 0 && (level.posargs > _remainder_start 
+			|| (_remainder_start > 0 && level.posargs == _remainder_start))){
+		push._remainder = true;
+		return;
+	}
+	if (level.pending >= 0){
+		// Values of the last optarg, up to the first token that is not one
+		const Argument& arg = _optlist[level.pending];
+		push._slot.val.str.clear();
+		push._slot.val.num.clear();
+		int setresult = arg.set(push._slot, given, _has_digit_opt);
+		if (setresult == 1 || setresult == 3)
+			return push.fail(arg.error(setresult, given));
+		if (setresult == 0){
+			level.pending_count++;
+			if (arg._more_nargs == '?' || (arg._more_nargs == '\0' && level.pending_count == arg._nargs))
+				level.pending = -1;
+			return;
+		}
+		if (level.pending_count < level.pending_min)
+			return push.fail(arg.error(2));
+		level.pending = -1;
+	}
+	if (given == "--"){
+		level.only_posargs = true;
+		return;
+	}
+	
+	if (given.substr(0, 1) != "-" || level.only_posargs || (_subparsers.valid() && level.posargs > _subparser_index)){
+		level.posargs++;
+		if (level.max_posargs >= 0 && level.posargs > level.max_posargs)
+			push.unrecognized(given);
+		if (!_subparsers.valid() || level.posargs != _subparser_index+1) return;
+		
+		// Subcommand: the optargs of this parser can no longer be given
+		int cmd = _allow_abbrev? _subparsers.match(given) : _subparsers.find(given);
+		if (cmd == -2)
+			return push.fail("ambiguous command: " + std::string(given) + " could match " 
+					+ _subparsers.matches(given));
+		if (cmd < 0) return push.fail(_arglist[_subparser_index].error(3, given));
+		const ArgumentParser* sub = &_subparsers._subparsers[cmd];
+		sub->built();
+		if (!sub->_frozen) return push.fail("parser must be frozen before parsing");
+		if (level.missing > 0 && !push._help){
+			std::string reqlist = "";
+			for (int i=0; i<_optlist.size(); i++)
+				if (_optlist[i]._required && !level.found[i] && _optlist[i]._action != Action::Help 
+						&& _optlist[i]._action != Action::Version)
+					reqlist += (reqlist == ""? "" : ", ") + _optlist[i].get_id();
+			return push.fail("the following arguments are required: " + reqlist);
+		}
+		sub->push_level(push);
+		return;
+	}
+	
+	// j is the optarg that takes values from this token (if any)
+	int j = -1;
+	bool found = false, has_attached = false;
+	std::string_view attached;
+	std::string_view name = given.substr(0, given.find('='));
+	int lidx = match_long(name);
+	if (lidx == -2) return push.fail(ambiguous_option(name));
+	if (lidx >= 0){
+		if (_optlist[lidx]._valtype != ValType::Bool){
+			j = lidx;
+			has_attached = (name.size() < given.size());
+			if (has_attached) attached = given.substr(name.size()+1);
+			found = true;
+		}
+		else if (name.size() == given.size()){
+			if (_optlist[lidx]._action == Action::Help || _optlist[lidx]._action == Action::Version)
+				push._help = true;
+			found = true;
+		}
+		if (found && !level.found[lidx] && _optlist[lidx]._required) level.missing--;
+		if (found) level.found[lidx] = true;
+	}
+	else if (given.size() > 1 && given[1] != '-'){
+		for (int k=1; k<given.size(); k++){
+			int idx = _shortidx[(unsigned char)given[k]];
+			if (idx < 0){
+				found = false;
+				break;
+			}
+			found = true;
+			if (!level.found[idx] && _optlist[idx]._required) level.missing--;
+			level.found[idx] = true;
+			if (_optlist[idx]._valtype != ValType::Bool){
+				j = idx;
+				has_attached = (k+1 < given.size());
+				if (has_attached) attached = given.substr(k+1);
+				break;
+			}
+			if (_optlist[idx]._action == Action::Help || _optlist[idx]._action == Action::Version)
+				push._help = true;
+		}
+	}
+	if (!found){
+		push.unrecognized(given);
+		return;
+	}
+	if (j < 0) return;
+	
+	const Argument& arg = _optlist[j];
+	if (has_attached){
+		if (arg._nargs != 1 && arg._nargs != -1) return push.fail(arg.error(2));
+		push._slot.val.str.clear();
+		push._slot.val.num.clear();
+		int setresult = arg.set(push._slot, attached, _has_digit_opt, false);
+		if (setresult == 1 || setresult == 3) return push.fail(arg.error(setresult, attached));
+	}
+	else if (arg._more_nargs == '.') push._remainder = true;
+	else{
+		level.pending = j;
+		level.pending_count = 0;
+		level.pending_min = (arg._more_nargs == '\0'? arg._nargs : arg._more_nargs == '+'? 1 : 0);
+	}
+}
+
+void ArgumentParser::add_memory(MemoryStats& stats) const{
+	// Node-based containers are estimated as one block per element (plus the
+	// bucket array of hashed ones), and deques as blocks of 512 bytes
+	stats.schema.add(_optlist.capacity()*sizeof(Argument));
+	stats.schema.add(_arglist.capacity()*sizeof(Argument));
+	for (const auto& arg : _optlist) arg.add_memory(stats);
+	for (const auto& arg : _arglist) arg.add_memory(stats);
+	stats.schema.add(_args.capacity()*sizeof(std::string));
+	for (const auto& arg : _args) stats.schema.add(arg);
+	for (const std::string* str : {&_none_str, &_fromfile_prefix, &_prog, &_desc, &_epilog, 
+			&_usage, &_subparser_cmd, &_subparser_help, &_subparsers._title, 
+			&_subparsers._desc, &_subparsers._help, &_subparsers._dest, 
+			&_subparsers._metavar, &_subparsers._prog})
+		stats.schema.add(*str);
+	for (const auto& it : _defaults){
+		stats.schema.add(4*sizeof(void*) + sizeof(it));
+		stats.schema.add(it.first);
+		stats.schema.add(it.second);
+	}
+	
+	stats.indices.add(_helpargs.capacity()*sizeof(int));
+	stats.indices.add(_defslots.capacity()*sizeof(_defslots[0]));
+	stats.indices.add(_longtrie.capacity()*sizeof(TrieNode));
+	stats.indices.add(_longedges.capacity()*sizeof(_longedges[0]));
+	if (_optnames.size() > 0)
+		stats.indices.add(_optnames.bucket_count()*sizeof(void*));
+	for (const auto& it : _optnames){
+		stats.indices.add(2*sizeof(void*) + sizeof(it));
+		stats.indices.add(it.first);
+	}
+	stats.schema.add(_subparser_aliases.capacity()*sizeof(std::string));
+	for (const auto& alias : _subparser_aliases) stats.schema.add(alias);
+	if (_subparsers._commands.size() > 0)
+		stats.indices.add(_subparsers._commands.bucket_count()*sizeof(void*));
+	for (const auto& it : _subparsers._commands){
+		stats.indices.add(2*sizeof(void*) + sizeof(it));
+		stats.indices.add(it.first);
+	}
+	stats.indices.add(_subparsers._sorted.capacity()*sizeof(_subparsers._sorted[0]));
+	for (const auto& it : _subparsers._sorted) stats.indices.add(it.first);
+	if (!_subparser){
+		// The destinations and stats are shared with the subparsers
+		std::shared_lock<std::shared_mutex> guard(_dests->lock);
+		stats.schema.add(sizeof(ParserStats) + 2*sizeof(long));
+		stats.indices.add(sizeof(ParseResult::Dests) + 2*sizeof(long));
+		stats.indices.add(8*sizeof(void*));
+		for (int i=0; i<(_dests->names.size()*sizeof(std::string)+511)/512; i++)
+			stats.indices.add(512);
+		for (const auto& name : _dests->names) stats.indices.add(name);
+		if (_dests->index.size() > 0)
+			stats.indices.add(_dests->index.bucket_count()*sizeof(void*));
+		for (int i=0; i<_dests->index.size(); i++)
+			stats.indices.add(2*sizeof(void*) + sizeof(std::pair<std::string_view, int>));
+		stats.indices.add(_dests->binds.capacity()*sizeof(ParseResult::Binding));
+	}
+	
+	stats.help.add(_helpcache.rendered_usage);
+	stats.help.add(_helpcache.rendered_help);
 	
-	// True if (1) sname is within the given string, (2) the given string does not begin with '--',
-	// and (3) sname is not the last character (unless it is a flag)
-	return (sname != '\0' && found && cond1 && cond2);
+	stats.schema.add(_subparsers._subparsers.size()*sizeof(ArgumentParser));
+	for (const auto& parser : _subparsers._subparsers) parser.add_memory(stats);
 }
 
+std::string ArgumentParser::get_subparser_name() const{
+	// The command followed by its aliases, as in "checkout (co)"
+	std::string name = _subparser_cmd;
+	for (int i=0; i<_subparser_aliases.size(); i++)
+		name += (i == 0? " (" : ", ") + _subparser_aliases[i];
+	return name + (_subparser_aliases.size() > 0? ")" : "");
+}
 std::string ArgumentParser::get_subparser_help(int linecap, int indent, HelpFormatter format) const{
 	if (!_subparser) return "";
-	std::string helpstr = "    " + _subparser_cmd;
+	std::string helpstr = "    " + get_subparser_name();
 
 	if (_subparser_help != ""){
 		std::string help = _subparser_help;
@@ -1457,6 +2348,252 @@ std::string ArgumentParser::wrap(std::string input, int indent_level) const{
 	return trim(str);
 }
 
+// === PARSER STATS === {{{1
+//
+// Constructors {{{2
+ParserStats::Phase::Phase() : calls(0), ns(0), items(0){}
+ParserStats::Timer::Timer(Phase& phase) 
+		: _phase(&phase), _start(std::chrono::steady_clock::now()){}
+ParserStats::Timer::~Timer(){stop();}
+
+// Modifiers {{{2
+void ParserStats::Phase::reset(){
+	calls = ns = items = 0;
+}
+void ParserStats::Timer::stop(){
+	if (_phase == nullptr) return;
+	auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now() - _start).count();
+	_phase->calls.fetch_add(1, std::memory_order_relaxed);
+	_phase->ns.fetch_add(ns, std::memory_order_relaxed);
+	_phase = nullptr;
+}
+void ParserStats::reset(){
+	for (Phase* phase : {&registration, &freeze, &help, &files, &optargs, &posargs, 
+			&dispatch, &defaults})
+		phase->reset();
+}
+
+// Accessors {{{2
+std::string ParserStats::format() const{
+	// One line per phase: name, calls, total microseconds, items
+	const std::pair<const char*, const Phase*> phases[] = {{"registration", &registration},
+		{"freeze", &freeze}, {"help", &help}, {"files", &files}, {"optargs", &optargs},
+		{"posargs", &posargs}, {"dispatch", &dispatch}, {"defaults", &defaults}};
+	std::ostringstream ss;
+	ss << "phase         calls      us         items\n";
+	for (const auto& it : phases){
+		ss << std::left << std::setw(14) << it.first << std::setw(11) << it.second->calls.load()
+			<< std::setw(11) << it.second->ns.load()/1000 << it.second->items.load() << "\n";
+	}
+	return ss.str();
+}
+
+// === MEMORY STATS === {{{1
+//
+// Modifiers {{{2
+void MemoryStats::Usage::add(long long size){
+	if (size <= 0) return;
+	allocations++;
+	bytes += size;
+}
+void MemoryStats::Usage::add(const std::string& str){
+	// Strings short enough to be stored within the object use no heap
+	const char* object = reinterpret_cast<const char*>(&str);
+	if (str.data() < object || str.data() >= object + sizeof(str))
+		add(str.capacity() + 1);
+}
+
+// Accessors {{{2
+MemoryStats::Usage MemoryStats::total() const{
+	Usage usage;
+	for (const Usage* it : {&schema, &indices, &help, &results, &files}){
+		usage.allocations += it->allocations;
+		usage.bytes += it->bytes;
+	}
+	return usage;
+}
+std::string MemoryStats::format() const{
+	// One line per subsystem: name, allocations, bytes
+	const std::pair<const char*, Usage> usages[] = {{"schema", schema}, {"indices", indices},
+		{"help", help}, {"results", results}, {"files", files}, {"total", total()}};
+	std::ostringstream ss;
+	ss << "memory        allocations  bytes\n";
+	for (const auto& it : usages){
+		ss << std::left << std::setw(14) << it.first << std::setw(13) 
+			<< it.second.allocations << it.second.bytes << "\n";
+	}
+	return ss.str();
+}
+
+// === COUNTING RESOURCE === {{{1
+//
+// Constructors {{{2
+CountingResource::CountingResource(std::pmr::memory_resource* upstream) 
+		: _upstream(upstream), _live(0), _peak(0), _files(this){}
+CountingResource::Files::Files(CountingResource* owner) : _owner(owner){}
+
+// Modifiers {{{2
+void CountingResource::reset(){
+	_stats = MemoryStats();
+	_peak = _live;
+}
+
+// Accessors {{{2
+const MemoryStats& CountingResource::stats() const{return _stats;}
+long long CountingResource::live() const{return _live;}
+long long CountingResource::peak() const{return _peak;}
+
+// Private Modifiers {{{2
+void* CountingResource::do_allocate(size_t bytes, size_t align){
+	return allocate_as(bytes, align, _stats.results);
+}
+void CountingResource::do_deallocate(void* ptr, size_t bytes, size_t align){
+	deallocate_as(ptr, bytes, align);
+}
+bool CountingResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept{
+	return this == &other;
+}
+void* CountingResource::allocate_as(size_t bytes, size_t align, MemoryStats::Usage& usage){
+	void* ptr = _upstream->allocate(bytes, align);
+	usage.add(bytes);
+	_live += bytes;
+	_peak = std::max(_peak, _live);
+	return ptr;
+}
+void CountingResource::deallocate_as(void* ptr, size_t bytes, size_t align){
+	_upstream->deallocate(ptr, bytes, align);
+	_live -= bytes;
+}
+void* CountingResource::Files::do_allocate(size_t bytes, size_t align){
+	return _owner->allocate_as(bytes, align, _owner->_stats.files);
+}
+void CountingResource::Files::do_deallocate(void* ptr, size_t bytes, size_t align){
+	_owner->deallocate_as(ptr, bytes, align);
+}
+bool CountingResource::Files::do_is_equal(const std::pmr::memory_resource& other) const noexcept{
+	return this == &other;
+}
+
+// === PARSE TRACE === {{{1
+//
+// Constructors {{{2
+thread_local ParseTrace* ParseTrace::_current = nullptr;
+ParseTrace::ParseTrace() : _start(std::chrono::steady_clock::now()){}
+ParseTrace::Scope::Scope(ParseTrace& trace) : _previous(_current){
+	_current = &trace;
+}
+ParseTrace::Scope::~Scope(){_current = _previous;}
+ParseTrace::Span::Span(const char* cat, std::string_view name) 
+		: _trace(_current), _event(-1){
+	if (_trace == nullptr) return;
+	_event = _trace->_events.size();
+	_trace->_events.push_back({'X', cat, std::string(name), "", _trace->now(), 0});
+}
+ParseTrace::Span::~Span(){end();}
+
+// Modifiers {{{2
+void ParseTrace::Span::end(){
+	if (_trace == nullptr) return;
+	Event& event = _trace->_events[_event];
+	event.dur = _trace->now() - event.ts;
+	_trace = nullptr;
+}
+void ParseTrace::clear(){
+	_events.clear();
+	_start = std::chrono::steady_clock::now();
+}
+
+// Accessors {{{2
+int ParseTrace::size() const{return _events.size();}
+std::string ParseTrace::json() const{
+	std::ostringstream ss;
+	ss << std::fixed << std::setprecision(3) << "{\"traceEvents\": [";
+	for (int i=0; i<_events.size(); i++){
+		const Event& event = _events[i];
+		ss << (i? ",\n" : "\n") << "{\"name\": \"" << escape(event.name) << "\", \"cat\": \""
+			<< event.cat << "\", \"ph\": \"" << event.phase << "\", \"ts\": " << event.ts;
+		if (event.phase == 'X') ss << ", \"dur\": " << event.dur;
+		else ss << ", \"s\": \"t\"";
+		ss << ", \"pid\": 1, \"tid\": 1, \"args\": {" << event.args << "}}";
+	}
+	ss << "\n], \"displayTimeUnit\": \"ns\"}\n";
+	return ss.str();
+}
+ParseTrace* ParseTrace::current(){return _current;}
+
+// Private Helpers {{{2
+void ParseTrace::add(const char* cat, std::string_view name, 
+		std::initializer_list<std::pair<const char*, std::string>> args){
+	std::string str;
+	for (const auto& arg : args){
+		if (str != "") str += ", ";
+		str += "\"" + escape(arg.first) + "\": \"" + escape(arg.second) + "\"";
+	}
+	_events.push_back({'i', cat, std::string(name), str, now(), 0});
+}
+double ParseTrace::now() const{
+	return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - _start).count();
+}
+std::string ParseTrace::escape(std::string_view str){
+	std::string result;
+	for (char c : str){
+		if (c == '"' || c == '\\') result += std::string("\\") + c;
+		else if ((unsigned char)c < 0x20){
+			char code[8];
+			std::snprintf(code, sizeof(code), "\\u%04x", c);
+			result += code;
+		}
+		else result += c;
+	}
+	return result;
+}
+
+// === HELP CACHE === {{{1
+//
+// Constructors {{{2
+ArgumentParser::HelpCache::HelpCache() : valid(false){}
+// The cache is deliberately not copied: the copy renders its own help
+ArgumentParser::HelpCache::HelpCache(const HelpCache&) : valid(false){}
+
+// Operators {{{2
+ArgumentParser::HelpCache& ArgumentParser::HelpCache::operator=(const HelpCache&){
+	// Deliberately not copied, as in the copy constructor
+	valid = false;
+	return *this;
+}
+
+// === FACTORY === {{{1
+//
+// Constructors {{{2
+ArgumentParser::Factory::Factory() : built(false){}
+ArgumentParser::Factory::Factory(const Factory& other) 
+		: build(other.build), built(other.built.load()){}
+
+// Operators {{{2
+ArgumentParser::Factory& ArgumentParser::Factory::operator=(const Factory& other){
+	build = other.build;
+	built = other.built.load();
+	return *this;
+}
+
+// === PARSE STATE === {{{1
+//
+// Constructor {{{2
+ArgumentParser::ParseState::ParseState(const ArgumentParser& parser, 
+		std::pmr::memory_resource* mem) : opt(mem), pos(mem){
+	opt.reserve(parser._optlist.size());
+	pos.reserve(parser._arglist.size());
+	for (int i=0; i<parser._optlist.size(); i++){
+		opt.emplace_back(mem);
+		if (parser._optlist[i]._action == Action::Count)
+			opt[i].val = parser._optlist[i]._defval;
+	}
+	for (int i=0; i<parser._arglist.size(); i++) pos.emplace_back(mem);
+}
+ArgumentParser::ParseState::Slot::Slot(std::pmr::memory_resource* mem) 
+		: found(false), val(mem){}
+
 // === ARGUMENTS === {{{1
 //
 // Constructors {{{2
@@ -1468,15 +2605,19 @@ ArgumentParser::Argument::Argument(){
 	_help = "";
 	_nargs = 0;
 	_more_nargs = '\0';
-	_found = _required = _subparser = false;
+	_required = _subparser = false;
 	_has_default = _override_metavar = false; 
+	_parser = nullptr;
+	_dests = nullptr;
+	_slot = -1;
 }
 
 ArgumentParser::Argument::Argument(ArgType type, ValType valtype, 
 		std::string sname, std::string lname) : _type(type), 
 		_valtype(valtype), _sname(sname), _lname(lname), _nargs(1), 
-		_required(false), _more_nargs('\0'), _has_default(false), 
-		_override_metavar(false), _found(false), _subparser(false){
+		_parser(nullptr), _dests(nullptr), _slot(-1), _required(false), 
+		_more_nargs('\0'), _has_default(false), _override_metavar(false), 
+		_subparser(false){
 	std::string metavar = "";
 	if (type == ArgType::Optarg){
 		if (lname != ""){
@@ -1510,14 +2651,14 @@ std::string ArgumentParser::Argument::error(std::string msg) const{
 	else result += msg;
 	return result;
 }
-std::string ArgumentParser::Argument::error(int code, std::string msg) const{
+std::string ArgumentParser::Argument::error(int code, std::string_view msg) const{
 	std::string result = "argument " + get_id() + ": ";
 	if (code == 1){//invalid type given
 		std::string type = "";
 		if (_valtype == ValType::Int) type = "int ";
 		else if (_valtype == ValType::Float) type = "float ";
 		result += "invalid " + type + "value";
-		result += ": '" + msg + "'";
+		result += ": '" + std::string(msg) + "'";
 	}
 	else if (code == 2){//expected (nargs) arguments
 		result += "expected ";
@@ -1527,7 +2668,7 @@ std::string ArgumentParser::Argument::error(int code, std::string msg) const{
 		else result += std::to_string(_nargs) + " arguments";
 	}
 	else if (code == 3){//invalid choice
-		result += "invalid choice: '" + msg 
+		result += "invalid choice: '" + std::string(msg) 
 			+ "' (choose from '" + _choices[0];
 		for (int i=1; i<_choices.size(); i++)
 			result += "', '" + _choices[i];
@@ -1541,7 +2682,7 @@ std::string ArgumentParser::Argument::error(int code, std::string msg) const{
 ArgumentParser::Argument& ArgumentParser::Argument::nargs(int nargs){
 	if (_valtype != ValType::Bool && nargs > 0)
 		_nargs = nargs;
-	return *this;
+	return changed();
 }
 ArgumentParser::Argument& ArgumentParser::Argument::nargs(char nargs){
 	if (nargs != '?' && nargs != '+' && nargs != '*')
@@ -1552,7 +2693,7 @@ ArgumentParser::Argument& ArgumentParser::Argument::nargs(char nargs){
 	}
 	if (nargs != '+' && _type == ArgType::Posarg)
 		_required = false;
-	return *this;
+	return changed();
 }
 ArgumentParser::Argument& ArgumentParser::Argument::nargs(std::string nargs){
 	if (nargs != "?" && nargs != "*" && nargs != "+" && nargs != "...")
@@ -1563,79 +2704,41 @@ ArgumentParser::Argument& ArgumentParser::Argument::nargs(std::string nargs){
 	}
 	if (nargs != "+" && _type == ArgType::Posarg)
 		_required = false;
-	
-	//TODO Remove once work begins on REMAINDER parsing
-	if (_more_nargs == '.') _more_nargs = '*';
-	
-	return *this;
+	return changed();
 }
 ArgumentParser::Argument& ArgumentParser::Argument::choices(std::string choices, char delim){
 	if (_valtype == ValType::Bool) return *this;
-	std::vector<std::string> result;
-	std::string temp="";
-	std::string final_choices="";
+	// Choices that are not valid values of the arg's type are dropped
+	_choices.clear();
+	_choiceidx.clear();
+	if (!_override_metavar) _metavar[0] = "{}";
 	
-	for (int i=0; i<choices.size(); i++){
-		if (choices[i] != delim) temp += choices[i];
-		else{
-			if (_valtype == ValType::Int){
-				char *ending;
-				int value = strtol(temp.c_str(), &ending, 10);
-				if (std::string(ending) != "") continue;
-			}
-			else if (_valtype == ValType::Float){
-				char *ending;
-				double value = strtod(temp.c_str(), &ending);
-				if (std::string(ending) != "") continue;
-			}
-			result.push_back(temp);
-			final_choices += (final_choices==""? "":",") + temp;
-			temp = "";
-		}
-	}
-	if (_valtype == ValType::Int){
-		char *ending;
-		int value = strtol(temp.c_str(), &ending, 10);
-		if (std::string(ending) == ""){
-			result.push_back(temp);
-			final_choices += (final_choices==""? "":",") + temp;
-		}
+	std::string_view rest = choices;
+	while (true){
+		std::string_view temp = rest.substr(0, rest.find(delim));
+		ParseResult::Number num;
+		if (convert(temp, num)) add_choice(std::string(temp));
+		if (temp.size() == rest.size()) break;
+		rest.remove_prefix(temp.size()+1);
 	}
-	else if (_valtype == ValType::Float){
-		char *ending;
-		double value = strtod(temp.c_str(), &ending);
-		if (std::string(ending) == ""){
-			result.push_back(temp);
-			final_choices += (final_choices==""? "":",") + temp;
-		}
-	}
-	else{
-		result.push_back(temp);
-		final_choices += (final_choices==""? "":",") + temp;
-	}
-	
-	_choices = result;
 	
-	if (!_override_metavar)
-		_metavar[0] = "{" + final_choices + "}";
-
-	return *this;
+	return changed();
 }
 ArgumentParser::Argument& ArgumentParser::Argument::required(bool required){
 	if (_type == ArgType::Optarg){
 		_required = required;
 	}
-	return *this;
+	return changed();
 }
 ArgumentParser::Argument& ArgumentParser::Argument::dest(std::string dest){
 	if (dest == "") return *this;
 	if (!_subparser && _type == ArgType::Posarg) return *this;
 	_dest = dest;
-	return *this;
+	return changed();
 }
 ArgumentParser::Argument& ArgumentParser::Argument::help(std::string help){
 	_help = trim(help);
-	return *this;
+	return changed();
 }
 ArgumentParser::Argument& ArgumentParser::Argument::metavar(std::string metavar, char delim){
 	if (_override_metavar) return *this;
@@ -1659,7 +2762,7 @@ ArgumentParser::Argument& ArgumentParser::Argument::metavar(std::string metavar,
 			_metavar = result;
 	}
 	_override_metavar = true;
-	return *this;
+	return changed();
 }
 ArgumentParser::Argument& ArgumentParser::Argument::def(std::string def, char delim){
 	if (!_required || _valtype == ValType::Bool){
@@ -1688,10 +2791,8 @@ ArgumentParser::Argument& ArgumentParser::Argument::def(std::string def, char de
 		}
 		if (_valtype == ValType::Bool && _action == Action::Count){
 			if (result.size() == 1){
-				char *ending;
-				int temp = strtol(result[0].c_str(), &ending, 10);
-				if ((std::string)ending == ""){
-					_val = result;
+				int temp;
+				if (parse_number(result[0], temp)){
 					_def = result;
 					_has_default = true;
 				}
@@ -1702,7 +2803,7 @@ ArgumentParser::Argument& ArgumentParser::Argument::def(std::string def, char de
 			_has_default = true;
 		}
 	}
-	return *this;
+	return changed();
 }
 //TODO figure out what cases this should/shouldn't run
 ArgumentParser::Argument& ArgumentParser::Argument::constant(std::string con, char delim){
@@ -1720,85 +2821,148 @@ ArgumentParser::Argument& ArgumentParser::Argument::constant(std::string con, ch
 		result.push_back(temp);
 		_const = result;
 	}
-	return *this;
+	return changed();
 }
 ArgumentParser::Argument& ArgumentParser::Argument::version(std::string version){
 	if (version == "" || _valtype != ValType::Bool) return *this;
 	_action = Action::Version;
 	_version = version;
 	if (_help == "") _help = "show program's version number and exit";
-	return *this;
+	return changed();
 }
 ArgumentParser::Argument& ArgumentParser::Argument::print_help(){
 	if (_action != Action::Store || _valtype != ValType::Bool)
 		return *this;
 	_action = Action::Help;
-	return *this;
+	return changed();
 }
 ArgumentParser::Argument& ArgumentParser::Argument::count(){
 	if (_valtype == ValType::Bool && _action == Action::Store){
 		_action = Action::Count;
-		_val.clear();
-		_val.push_back("0");
-		_def = _val;
+		_def = std::vector<std::string>{"0"};
 		_has_default = true;
 	}
-	return *this;
+	return changed();
+}
+
+// Conversions {{{2
+ArgumentParser::Argument::operator Handle() const{
+	return Handle(_dests? _dests->add(_dest) : -1);
 }
 
 // Modifiers {{{2
-int ArgumentParser::Argument::set(std::string value, bool has_digit_opt, 
-		bool careful){
-	// Exit Codes:
+ArgumentParser::Argument& ArgumentParser::Argument::changed(){
+	// The parser is frozen again (and its help rendered again) before it
+	// next parses or prints
+	if (_parser != nullptr){
+		_parser->_frozen = false;
+		_parser->_helpcache.valid = false;
+	}
+	return *this;
+}
+void ArgumentParser::Argument::add_choice(std::string choice){
+	_choiceidx.emplace(std::hash<std::string_view>()(choice), _choices.size());
+	_choices.push_back(choice);
+	if (!_override_metavar){
+		// The metavar is extended rather than rebuilt
+		if (_metavar.size() == 0) _metavar.push_back("{}");
+		else if (_choices.size() == 1) _metavar[0] = "{}";
+		std::string& metavar = _metavar[0];
+		metavar.insert(metavar.size()-1, (_choices.size() > 1? "," : "") + choice);
+	}
+}
+void ArgumentParser::Argument::load_values(){
+	// Defaults and constants are converted once so that each parse can copy
+	// them as they are (values that are not valid stay as text)
+	_defval = ParseResult::Values();
+	_constval = ParseResult::Values();
+	for (const auto& def : _def){
+		ParseResult::Number num;
+		if (!convert(def, num)) num = std::monostate();
+		_defval.str.push_back(def);
+		_defval.num.push_back(num);
+	}
+	for (const auto& con : _const){
+		ParseResult::Number num;
+		if (!convert(con, num)) num = std::monostate();
+		_constval.str.push_back(con);
+		_constval.num.push_back(num);
+	}
+}
+
+// Accessors {{{2
+int ArgumentParser::Argument::set(ParseState::Slot& slot, std::string_view value, 
+		bool has_digit_opt, bool careful) const{
+	// Exit Codes (matching the error codes):
 	// 	0: Success
-	// 	1: Not a valid choice
+	// 	1: Not a valid value for the type
 	// 	2: Encountered optarg (no values given)
-	_found = true;
-	bool valid_choice = true;
-	if (_choices.size() != 0){
-		valid_choice = false;
-		for (int i=0; i<_choices.size(); i++){
-			if (value == _choices[i]){
-				valid_choice = true;
-				break;
-			}
-		}
-	}
-	if (careful){
-		if (value[0] == '-' && value.size() > 1){
-			if (isdigit(value[1]) && !has_digit_opt){
-				if (!valid_choice) return 1;
-				if (_more_nargs == '\0' && _val.size() >= _nargs) _val.clear();
-				_val.push_back(value);
-				return 0;
-			}
-			else return 2;
+	// 	3: Not a valid choice
+	slot.found = true;
+	if (careful && value.size() > 1 && value[0] == '-'){
+		if (!isdigit(value[1]) || has_digit_opt) return 2;
+	}
+	ParseResult::Number num;
+	if (!convert(value, num)) return 1;
+	if (!valid_choice(value)) return 3;
+	if (_more_nargs == '\0' && slot.val.size() >= _nargs){
+		slot.val.str.clear();
+		slot.val.num.clear();
+	}
+	slot.val.str.push_back(value);
+	slot.val.num.push_back(num);
+	return 0;
+}
+
+int ArgumentParser::Argument::set(ParseState::Slot& slot, const std::string_view* begin, 
+		const std::string_view* end, std::string_view& bad) const{
+	// Stores every value without checking for optargs (as for REMAINDER).
+	// Returns the exit code of the first value that is not valid (which is
+	// stored in bad), or 0
+	slot.found = true;
+	if (_valtype == ValType::String && _choices.size() == 0){
+		// Nothing to check, so the views are stored as they are
+		slot.val.str.insert(slot.val.str.end(), begin, end);
+		slot.val.num.resize(slot.val.str.size());
+		return 0;
+	}
+	for (const std::string_view* it = begin; it != end; it++){
+		int setresult = set(slot, *it, false, false);
+		if (setresult != 0){
+			bad = *it;
+			return setresult;
 		}
 	}
-	if (!valid_choice) return 1;
-	if (_more_nargs == '\0' && _val.size() >= _nargs) _val.clear();
-	_val.push_back(value);
 	return 0;
 }
 
-void ArgumentParser::Argument::add_choice(std::string choice){
-	_choices.push_back(choice);
-	if (!_override_metavar){
-		std::string metavar = "{" + _choices[0];
-		for (int i=1; i<_choices.size(); i++)
-			metavar += "," + _choices[i];
-		metavar += "}";
-		if (_metavar.size() == 0)
-			_metavar.push_back(metavar);
-		else _metavar[0] = metavar;
+bool ArgumentParser::Argument::convert(std::string_view value, 
+		ParseResult::Number& num) const{
+	// Stores the native form of value in num (std::monostate for args that
+	// are kept as text), returning false if the value is not valid
+	num = std::monostate();
+	if (_action == Action::Count || _valtype == ValType::Int){
+		int val;
+		if (!parse_number(value, val)) return false;
+		num = val;
 	}
+	else if (_valtype == ValType::Float){
+		double val;
+		if (!parse_number(value, val)) return false;
+		num = val;
+	}
+	else if (_valtype == ValType::Bool && _action == Action::Store)
+		num = (value == TRUE);
+	return true;
 }
 
-// Accessors {{{2
-const std::string& ArgumentParser::Argument::operator[](int index) const{
-	return _val[index];
+bool ArgumentParser::Argument::valid_choice(std::string_view value) const{
+	if (_choices.size() == 0) return true;
+	auto range = _choiceidx.equal_range(std::hash<std::string_view>()(value));
+	for (auto it = range.first; it != range.second; it++)
+		if (_choices[it->second] == value) return true;
+	return false;
 }
-int ArgumentParser::Argument::size() const{return _val.size();}
 
 std::string ArgumentParser::Argument::get_id() const{
 	std::string id;
@@ -1847,9 +3011,8 @@ std::string ArgumentParser::Argument::get_help_id(HelpFormatter format) const{
 				helpstr += " " + metavar 
 					+ " [" + metavar + " ...]";
 			else if (_more_nargs == '.')
-				helpstr += "...";
+				helpstr += " ...";
 		}
-		else if (_more_nargs == '.') helpstr += "...";
 		else helpstr += metavar;
 		if (_lname != "") helpstr += ", ";
 	}
@@ -1867,7 +3030,7 @@ std::string ArgumentParser::Argument::get_help_id(HelpFormatter format) const{
 			helpstr += " " + metavar 
 				+ " [" + metavar + " ...]";
 		else if (_more_nargs == '.')
-			helpstr += "...";
+			helpstr += " ...";
 	}
 	return helpstr;
 }
@@ -1905,14 +3068,14 @@ std::string ArgumentParser::Argument::get_usage(HelpFormatter format) const{
 		else if (_more_nargs == '*') usagestr += " [" + metavar + " ...]"; 
 		else if (_more_nargs == '+') 
 			usagestr += " " + metavar + " [" + metavar + " ...]";
-		else if (_more_nargs == '.') usagestr += "...";
+		else if (_more_nargs == '.') usagestr += " ...";
 	}
+	else if (_more_nargs == '.') return "...";
 	else{
 		usagestr += metavar;
 		if (_more_nargs == '*' || _subparser) usagestr += " ...";
 		else if (_more_nargs == '+') 
 			usagestr += " [" + metavar + " ...]";
-		else if (_more_nargs == '.') usagestr += "...";
 	}
 	
 	if (!_required && !_subparser) usagestr = "[" + usagestr + "]";
@@ -2022,6 +3185,22 @@ std::string ArgumentParser::Argument::trim(std::string str) const{
 
 	return str;
 }
+void ArgumentParser::Argument::add_memory(MemoryStats& stats) const{
+	for (const std::string* str : {&_sname, &_lname, &_dest, &_help, &_version})
+		stats.schema.add(*str);
+	for (const auto* vec : {&_metavar, &_def, &_choices, &_const}){
+		stats.schema.add(vec->capacity()*sizeof(std::string));
+		for (const auto& str : *vec) stats.schema.add(str);
+	}
+	if (_choiceidx.size() > 0)
+		stats.indices.add(_choiceidx.bucket_count()*sizeof(void*));
+	for (int i=0; i<_choiceidx.size(); i++)
+		stats.indices.add(sizeof(void*) + sizeof(std::pair<size_t, int>));
+	for (const auto* vals : {&_defval, &_constval}){
+		stats.indices.add(vals->str.capacity()*sizeof(std::string_view));
+		stats.indices.add(vals->num.capacity()*sizeof(ParseResult::Number));
+	}
+}
 
 // === SUBPARSERS === {{{1
 //
@@ -2036,49 +3215,73 @@ ArgumentParser::SubparserList& ArgumentParser::SubparserList::title(std::string
 	if (title == "") return *this;
 	if (!_override_title) _title = title;
 	_override_title = true;
+	if (_parser != nullptr) _parser->_frozen = false;
 	return *this;
 }
 ArgumentParser::SubparserList& ArgumentParser::SubparserList::description(std::string desc){
 	if (desc == "" || _desc != "") return *this;
 	if (_title == "") _title = "subcommands";
 	_desc = desc;
+	if (_parser != nullptr) _parser->_frozen = false;
 	return *this;
 }
 ArgumentParser::SubparserList& ArgumentParser::SubparserList::prog(std::string prog){
 	if (prog == "" || _prog != "") return *this;
 	_prog = prog;
+	if (_parser != nullptr) _parser->_frozen = false;
 	return *this;
 }
 ArgumentParser::SubparserList& ArgumentParser::SubparserList::dest(std::string dest){
-	if (_parser != nullptr) _parser->_arglist[_arg].dest(dest);
+	if (_parser != nullptr){
+		_parser->_arglist[_arg].dest(dest);
+		_parser->_frozen = false;
+	}
 	return *this;
 }
 ArgumentParser::SubparserList& ArgumentParser::SubparserList::help(std::string help){
-	if (_parser != nullptr) _parser->_arglist[_arg].help(help);
+	if (_parser != nullptr){
+		_parser->_arglist[_arg].help(help);
+		_parser->_frozen = false;
+	}
 	return *this;
 }
 ArgumentParser::SubparserList& ArgumentParser::SubparserList::metavar(std::string metavar){
-	if (_parser != nullptr) _parser->_arglist[_arg].metavar(metavar);
+	if (_parser != nullptr){
+		_parser->_arglist[_arg].metavar(metavar);
+		_parser->_frozen = false;
+	}
 	return *this;
 }
 ArgumentParser::SubparserList& ArgumentParser::SubparserList::required(bool required){
-	if (_parser != nullptr) _parser->_arglist[_arg].required(required);
+	if (_parser != nullptr){
+		_parser->_arglist[_arg].required(required);
+		_parser->_frozen = false;
+	}
 	return *this;
 }
 
 // Modifiers {{{2
-ArgumentParser& ArgumentParser::SubparserList::add_parser(std::string cmd){
-	std::vector<char*> temp;
-	temp.push_back(const_cast<char*>(_parser->_prog.c_str()));
-	for (int i=0; i<_parser->_nargs; i++)
-		temp.push_back(const_cast<char*>(_parser->_args[i].c_str()));
+ArgumentParser& ArgumentParser::SubparserList::add_parser(std::string cmd, 
+		std::vector<std::string> aliases){
+	// A name given twice keeps its first subparser
 	_parser->_arglist[_arg].add_choice(cmd);
-	ArgumentParser parser(_parser->_nargs, temp.data());
-	parser._subparser = true;
-	parser._subparser_cmd = cmd;
-	_subparsers.push_back(parser);
+	_commands.emplace(cmd, _subparsers.size());
+	for (const auto& alias : aliases){
+		_parser->_arglist[_arg].add_choice(alias);
+		_commands.emplace(alias, _subparsers.size());
+	}
+	_parser->_frozen = false;
+	_subparsers.push_back(ArgumentParser(*_parser, cmd));
+	_subparsers.back()._subparser_aliases = std::move(aliases);
 	return _subparsers.back();
 }
+ArgumentParser::SubparserList& ArgumentParser::SubparserList::add_parser(std::string cmd, std::string help,
+		std::function<void(ArgumentParser&)> build, std::vector<std::string> aliases){
+	ArgumentParser& parser = add_parser(cmd, std::move(aliases));
+	parser.help(help);
+	parser._factory.build = std::move(build);
+	return *this;
+}
 
 // Private Modifiers {{{2
 void ArgumentParser::SubparserList::add(ArgumentParser* parser){
@@ -2090,10 +3293,102 @@ void ArgumentParser::SubparserList::add(ArgumentParser* parser){
 	_parser->_arglist[_arg]._dest = "";
 	_parser->_arglist[_arg]._metavar[0] = "{}";
 }
+void ArgumentParser::SubparserList::load_commands(){
+	_sorted.assign(_commands.begin(), _commands.end());
+	std::sort(_sorted.begin(), _sorted.end());
+}
 
 // Accessors {{{2
 const ArgumentParser& ArgumentParser::SubparserList::operator[](int index) const{
-	return _subparsers[index];
+	return _subparsers[index].built();
 }
 int ArgumentParser::SubparserList::size() const{return _subparsers.size();}
 bool ArgumentParser::SubparserList::valid() const{return _parser != nullptr;}
+int ArgumentParser::SubparserList::find(std::string_view cmd) const{
+	auto it = _commands.find(std::string(cmd));
+	return (it == _commands.end())? -1 : it->second;
+}
+int ArgumentParser::SubparserList::match(std::string_view cmd) const{
+	// Index in _subparsers of the subparser named cmd, or of the only one
+	// with a name (or alias) that begins with cmd (-1 if there is none, -2 if
+	// it is ambiguous)
+	int index = find(cmd);
+	if (index >= 0 || cmd.empty()) return index;
+	auto it = std::lower_bound(_sorted.begin(), _sorted.end(), cmd,
+			[](const std::pair<std::string, int>& name, std::string_view cmd){return name.first < cmd;});
+	for (; it != _sorted.end() && it->first.compare(0, cmd.size(), cmd) == 0; it++){
+		if (index >= 0 && it->second != index) return -2;
+		index = it->second;
+	}
+	return index;
+}
+std::string ArgumentParser::SubparserList::matches(std::string_view cmd) const{
+	std::string result = "";
+	for (const auto& parser : _subparsers){
+		bool found = (parser._subparser_cmd.compare(0, cmd.size(), cmd) == 0);
+		for (const auto& alias : parser._subparser_aliases)
+			found = found || alias.compare(0, cmd.size(), cmd) == 0;
+		if (found) result += (result == ""? "" : ", ") + parser._subparser_cmd;
+	}
+	return result;
+}
+
+// === PUSH PARSER === {{{1
+//
+// Constructor {{{2
+PushParser::PushParser(const ArgumentParser& parser) 
+		: _parser(&parser), _slot(std::pmr::get_default_resource()){
+	reset();
+}
+
+// Modifiers {{{2
+PushParser::Status PushParser::push(std::string_view token){
+	_tokens.emplace_back(token);
+	_args.push_back(_tokens.back().c_str());
+	if (!_invalid && !_remainder) _levels.back().parser->push_token(*this, _tokens.back());
+	return status();
+}
+void PushParser::reset(){
+	_levels.clear();
+	_tokens.clear();
+	_args.assign(1, _parser->_prog.c_str());
+	_msg = _unrecognized = "";
+	_invalid = _help = _remainder = false;
+	if (!_parser->frozen()) fail("parser must be frozen before parsing");
+	else _parser->push_level(*this);
+}
+
+// Accessors {{{2
+PushParser::Status PushParser::status() const{
+	if (_invalid) return Status::Invalid;
+	if (_help) return (needed() > 0? Status::NeedsValues : Status::Complete);
+	if (_unrecognized != "") return Status::Invalid;
+	return (needed() > 0? Status::NeedsValues : Status::Complete);
+}
+int PushParser::needed() const{
+	// Values needed by the last optarg, or else the positional values and
+	// required optargs still missing (none once help is asked for)
+	if (_invalid || _remainder || (_unrecognized != "" && !_help)) return 0;
+	const Level& level = _levels.back();
+	if (level.pending >= 0 && level.pending_count < level.pending_min)
+		return level.pending_min - level.pending_count;
+	if (_help) return 0;
+	return std::max(level.min_posargs - level.posargs, 0) + level.missing;
+}
+const std::string& PushParser::message() const{return _msg;}
+int PushParser::size() const{return _tokens.size();}
+ParseResult PushParser::result(std::pmr::memory_resource* mem) const{
+	// The result views the tokens (call own() on it to keep it after the
+	// PushParser is reset or destroyed)
+	return _parser->parse(_args.size(), _args.data(), mem);
+}
+
+// Private Helpers {{{2
+void PushParser::fail(std::string msg){
+	_invalid = true;
+	_msg = msg;
+}
+void PushParser::unrecognized(std::string_view token){
+	_unrecognized.append(" ").append(token);
+	if (!_invalid) _msg = "unrecognized arguments:" + _unrecognized;
+}
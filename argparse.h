@@ -3,11 +3,89 @@
 #define ARGPARSE_VERSION 2.2.7
 #include <iostream>
 #include <sstream>
+#include <iomanip>
+#include <cstdio>
 #include <fstream>
 #include <sys/ioctl.h>
 #include <string>
+#include <string_view>
+#include <charconv>
 #include <vector>
+#include <array>
 #include <map>
+#include <variant>
+#include <deque>
+#include <memory>
+#include <memory_resource>
+#include <unordered_map>
+#include <functional>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <shared_mutex>
+#include <atomic>
+#include <chrono>
+#include <typeinfo>
+#include <type_traits>
+
+// Adds an optarg bound to each listed member of a struct, typed from the
+// member (see ArgumentParser::add_field()). Up to 16 members can be listed
+#define ARGPARSE_FIELDS(parser, S, ...) \
+	ARGPARSE_EXPAND(ARGPARSE_FIELDS_N(__VA_ARGS__, ARGPARSE_FIELDS_16, \
+		ARGPARSE_FIELDS_15, ARGPARSE_FIELDS_14, ARGPARSE_FIELDS_13, \
+		ARGPARSE_FIELDS_12, ARGPARSE_FIELDS_11, ARGPARSE_FIELDS_10, \
+		ARGPARSE_FIELDS_9, ARGPARSE_FIELDS_8, ARGPARSE_FIELDS_7, \
+		ARGPARSE_FIELDS_6, ARGPARSE_FIELDS_5, ARGPARSE_FIELDS_4, \
+		ARGPARSE_FIELDS_3, ARGPARSE_FIELDS_2, ARGPARSE_FIELDS_1)(parser, S, __VA_ARGS__))
+#define ARGPARSE_FIELD(parser, S, field) (parser).add_field(&S::field, #field);
+#define ARGPARSE_EXPAND(x) x
+#define ARGPARSE_FIELDS_N(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, \
+		_13, _14, _15, _16, N, ...) N
+#define ARGPARSE_FIELDS_1(p, S, f) ARGPARSE_FIELD(p, S, f)
+#define ARGPARSE_FIELDS_2(p, S, f, ...) ARGPARSE_FIELD(p, S, f) ARGPARSE_EXPAND(ARGPARSE_FIELDS_1(p, S, __VA_ARGS__))
+#define ARGPARSE_FIELDS_3(p, S, f, ...) ARGPARSE_FIELD(p, S, f) ARGPARSE_EXPAND(ARGPARSE_FIELDS_2(p, S, __VA_ARGS__))
+#define ARGPARSE_FIELDS_4(p, S, f, ...) ARGPARSE_FIELD(p, S, f) ARGPARSE_EXPAND(ARGPARSE_FIELDS_3(p, S, __VA_ARGS__))
+#define ARGPARSE_FIELDS_5(p, S, f, ...) ARGPARSE_FIELD(p, S, f) ARGPARSE_EXPAND(ARGPARSE_FIELDS_4(p, S, __VA_ARGS__))
+#define ARGPARSE_FIELDS_6(p, S, f, ...) ARGPARSE_FIELD(p, S, f) ARGPARSE_EXPAND(ARGPARSE_FIELDS_5(p, S, __VA_ARGS__))
+#define ARGPARSE_FIELDS_7(p, S, f, ...) ARGPARSE_FIELD(p, S, f) ARGPARSE_EXPAND(ARGPARSE_FIELDS_6(p, S, __VA_ARGS__))
+#define ARGPARSE_FIELDS_8(p, S, f, ...) ARGPARSE_FIELD(p, S, f) ARGPARSE_EXPAND(ARGPARSE_FIELDS_7(p, S, __VA_ARGS__))
+#define ARGPARSE_FIELDS_9(p, S, f, ...) ARGPARSE_FIELD(p, S, f) ARGPARSE_EXPAND(ARGPARSE_FIELDS_8(p, S, __VA_ARGS__))
+#define ARGPARSE_FIELDS_10(p, S, f, ...) ARGPARSE_FIELD(p, S, f) ARGPARSE_EXPAND(ARGPARSE_FIELDS_9(p, S, __VA_ARGS__))
+#define ARGPARSE_FIELDS_11(p, S, f, ...) ARGPARSE_FIELD(p, S, f) ARGPARSE_EXPAND(ARGPARSE_FIELDS_10(p, S, __VA_ARGS__))
+#define ARGPARSE_FIELDS_12(p, S, f, ...) ARGPARSE_FIELD(p, S, f) ARGPARSE_EXPAND(ARGPARSE_FIELDS_11(p, S, __VA_ARGS__))
+#define ARGPARSE_FIELDS_13(p, S, f, ...) ARGPARSE_FIELD(p, S, f) ARGPARSE_EXPAND(ARGPARSE_FIELDS_12(p, S, __VA_ARGS__))
+#define ARGPARSE_FIELDS_14(p, S, f, ...) ARGPARSE_FIELD(p, S, f) ARGPARSE_EXPAND(ARGPARSE_FIELDS_13(p, S, __VA_ARGS__))
+#define ARGPARSE_FIELDS_15(p, S, f, ...) ARGPARSE_FIELD(p, S, f) ARGPARSE_EXPAND(ARGPARSE_FIELDS_14(p, S, __VA_ARGS__))
+#define ARGPARSE_FIELDS_16(p, S, f, ...) ARGPARSE_FIELD(p, S, f) ARGPARSE_EXPAND(ARGPARSE_FIELDS_15(p, S, __VA_ARGS__))
+
+// Times the rest of the scope (or up to ARGPARSE_STOP) as a phase of the
+// parser's stats, and counts the items it handled. Both are compiled away
+// unless ARGPARSE_STATS is defined when building the library
+#ifdef ARGPARSE_STATS
+#define ARGPARSE_TIME(phase) argparse::ParserStats::Timer argparse_timer_##phase(_stats->phase)
+#define ARGPARSE_STOP(phase) argparse_timer_##phase.stop()
+#define ARGPARSE_COUNT(phase, n) _stats->phase.items.fetch_add(n, std::memory_order_relaxed)
+#else
+#define ARGPARSE_TIME(phase)
+#define ARGPARSE_STOP(phase)
+#define ARGPARSE_COUNT(phase, n)
+#endif
+
+// Records an event, or a span lasting to the end of the scope (or up to
+// ARGPARSE_TRACE_END), in the ParseTrace active on this thread. Compiled away
+// unless ARGPARSE_TRACE is defined when building the library
+#ifdef ARGPARSE_TRACE
+#define ARGPARSE_TRACE_EVENT(cat, name, ...) do{ \
+		if (argparse::ParseTrace* trace_ = argparse::ParseTrace::current()) \
+			trace_->add(cat, name, {__VA_ARGS__}); \
+	} while (0)
+#define ARGPARSE_TRACE_SPAN(span, cat, name) argparse::ParseTrace::Span argparse_span_##span(cat, name)
+#define ARGPARSE_TRACE_END(span) argparse_span_##span.end()
+#else
+#define ARGPARSE_TRACE_EVENT(cat, name, ...)
+#define ARGPARSE_TRACE_SPAN(span, cat, name)
+#define ARGPARSE_TRACE_END(span)
+#endif
 
 namespace argparse{
 	// Constants and Enums 
@@ -276,10 +354,446 @@ namespace argparse{
 	typedef std::map<std::string, ArgumentValueList> ArgumentMap;
 	std::string format_args(ArgumentMap args);
 	void print_args(ArgumentMap args, std::ostream& out=std::cout);
+	// Converts all of str to a number in one pass (without allocating or
+	// depending on the locale). Returns false if str is not a number or it
+	// does not fit in T (int, unsigned, long long, unsigned long long, float
+	// or double)
+	template <typename T>
+	bool parse_number(std::string_view str, T& num);
+	
+	// HelpSnapshot Struct
+	// Usage and help of one parser, rendered ahead of time for a formatter
+	// and linecap. Tables of these are generated during the build (see
+	// ArgumentParser::write_help_snapshot()) and installed with
+	// ArgumentParser::precompiled_help()
+	struct HelpSnapshot {
+		const char* prog;
+		HelpFormatter format;
+		int linecap;
+		const char* usage;
+		const char* help;
+	};
+	
+	// ArgumentSpec Struct
+	// One row of a table of arguments for ArgumentParser::add_arguments().
+	// names is a posarg name or the option strings of an optarg (e.g.
+	// "-v,--verbose"), type is "str" (or empty), "int", "float" or "bool",
+	// nargs is a number or "?", "*", "+" or "...", and the other fields are
+	// given to the chain modifiers of the same name (the empty ones are left
+	// out)
+	struct ArgumentSpec {
+		std::string names = "", type = "", help = "", nargs = "";
+		std::string choices = "", def = "", dest = "", metavar = "";
+		bool required = false;
+	};
+	
+	// ParserStats Struct
+	// Time spent in each phase of a parser and its subparsers (which share
+	// its stats), how many times each ran, and how many items it handled.
+	// Only recorded when the library is built with ARGPARSE_STATS defined
+	struct ParserStats {
+		struct Phase {
+			// calls		= Number of times the phase ran
+			// ns			= Total time spent in the phase
+			// items		= Number of items handled by the phase
+			std::atomic<long long> calls, ns, items;
+			
+			Phase();
+			void reset();
+		};
+		// Timer Class
+		// Adds the time from its construction to stop() (or its destruction)
+		// to a phase
+		class Timer {
+		public:
+			explicit Timer(Phase& phase);
+			~Timer();
+			void stop();
+		private:
+			Phase* _phase;
+			std::chrono::steady_clock::time_point _start;
+		};
+		
+		void reset();
+		std::string format() const;
+		
+		// registration	= add_argument() (items: arguments added)
+		// freeze		= freeze() building the indices (items: arguments)
+		// help			= Rendering the usage and help (items: arguments)
+		// files		= Expanding response files (items: tokens after
+		// 					expansion)
+		// optargs		= Matching tokens to optargs (items: tokens)
+		// posargs		= Assigning positional values, including the
+		// 					dispatch to subparsers (items: positional values)
+		// dispatch		= Parsing with a subparser, including the phases of
+		// 					that parse (items: subcommands)
+		// defaults		= Filling defaults and checking required optargs
+		// 					(items: defaults filled)
+		Phase registration, freeze, help, files, optargs, posargs, dispatch, defaults;
+	};
+	
+	// MemoryStats Struct
+	// Heap memory by subsystem, either held by a parser (estimated from the
+	// sizes and capacities of its containers by ArgumentParser::memory()) or
+	// allocated by parses through a CountingResource
+	struct MemoryStats {
+		struct Usage {
+			// allocations	= Number of heap blocks
+			// bytes		= Total size of the blocks
+			long long allocations = 0, bytes = 0;
+			
+			void add(long long size);
+			void add(const std::string& str);
+		};
+		
+		Usage total() const;
+		std::string format() const;
+		
+		// schema		= Arguments, their names, help, defaults and choices,
+		// 					and the settings of the parser and its subparsers
+		// indices		= Tables built when freezing (option trie, choice
+		// 					indices, destinations, stored defaults)
+		// help			= Rendered usage and help
+		// results		= Values and parse state allocated by parses
+		// files		= Lines read from response files by parses
+		Usage schema, indices, help, results, files;
+	};
+	// CountingResource Class
+	// Memory resource that counts the allocations made through it before
+	// passing them on to an upstream resource. Parses read response files
+	// through its second resource (see Files), so that those allocations
+	// count as files and the rest as results. Like the standard pool
+	// resources, it must not be used by several threads at once
+	class CountingResource : public std::pmr::memory_resource {
+		friend class ArgumentParser;
+	public:
+		explicit CountingResource(std::pmr::memory_resource* upstream=std::pmr::get_default_resource());
+		CountingResource(const CountingResource& other) = delete;
+		CountingResource& operator=(const CountingResource& other) = delete;
+		
+		// Modifiers
+		void reset();
+		
+		// Accessors
+		const MemoryStats& stats() const;
+		long long live() const;
+		long long peak() const;
+	private:
+		// Files Class
+		// Resource that passes the allocations made through it on to its
+		// CountingResource, counting them as files
+		class Files : public std::pmr::memory_resource {
+		public:
+			explicit Files(CountingResource* owner);
+		private:
+			void* do_allocate(size_t bytes, size_t align) override;
+			void do_deallocate(void* ptr, size_t bytes, size_t align) override;
+			bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+			
+			// _owner		= Resource that counts the allocations
+			CountingResource* _owner;
+		};
+		
+		void* do_allocate(size_t bytes, size_t align) override;
+		void do_deallocate(void* ptr, size_t bytes, size_t align) override;
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+		void* allocate_as(size_t bytes, size_t align, MemoryStats::Usage& usage);
+		void deallocate_as(void* ptr, size_t bytes, size_t align);
+		
+		// _upstream		= Resource that allocates the memory
+		// _stats			= Allocations made so far
+		// _live			= Bytes allocated and not yet deallocated
+		// _peak			= Largest value of _live
+		// _files			= Resource that response files are read through
+		std::pmr::memory_resource* _upstream;
+		MemoryStats _stats;
+		long long _live, _peak;
+		Files _files;
+	};
+	
+	// ParseTrace Class
+	// Records the decisions of the parses that run on a thread while the
+	// trace is active there (see Scope): how each token was classified, the
+	// argument it matched and the values it took, each positional value
+	// tried against each posarg (and when one is moved on to the next), the
+	// dispatch to subparsers and errors, with timestamps. json() exports
+	// them in the Chrome trace-event format. Only recorded when the library
+	// is built with ARGPARSE_TRACE defined
+	class ParseTrace {
+		friend class ArgumentParser;
+		friend class ParseResult;
+	public:
+		// Scope Class
+		// Makes a trace active on the thread until it is destroyed
+		class Scope {
+		public:
+			explicit Scope(ParseTrace& trace);
+			Scope(const Scope&) = delete;
+			~Scope();
+		private:
+			ParseTrace* _previous;
+		};
+		// Span Class
+		// Records an event lasting from its construction to end() (or its
+		// destruction) in the active trace
+		class Span {
+		public:
+			Span(const char* cat, std::string_view name);
+			Span(const Span&) = delete;
+			~Span();
+			void end();
+		private:
+			ParseTrace* _trace;
+			int _event;
+		};
+		
+		ParseTrace();
+		
+		// Modifiers
+		void clear();
+		
+		// Accessors
+		int size() const;
+		std::string json() const;
+		static ParseTrace* current();
+	private:
+		// Event Struct
+		// phase	= 'i' for an instant, 'X' for a span
+		// ts, dur	= Start and duration in microseconds since the trace began
+		// args		= Arguments of the event, as the members of a JSON object
+		struct Event {
+			char phase;
+			std::string cat, name, args;
+			double ts, dur;
+		};
+		
+		void add(const char* cat, std::string_view name, 
+				std::initializer_list<std::pair<const char*, std::string>> args);
+		double now() const;
+		static std::string escape(std::string_view str);
+		
+		// _events			= Events in the order they began
+		// _start			= Time the trace began
+		// _current			= Trace active on this thread (nullptr if none)
+		std::vector<Event> _events;
+		std::chrono::steady_clock::time_point _start;
+		static thread_local ParseTrace* _current;
+	};
+	
+	class ArgumentParser;
+	class PushParser;
+	// Handle Class
+	// Refers to the values of an argument's destination in any result of its
+	// parser, so that they can be read without looking up the name. The
+	// reference returned by add_argument() converts to the handle of the
+	// argument's (current) destination
+	class Handle {
+		friend class ParseResult;
+		friend class ArgumentParser;
+	public:
+		Handle();
+		
+		// Accessors
+		bool valid() const;
+	private:
+		explicit Handle(int slot);
+		
+		// _slot			= Index of the destination in the results of a
+		// 						parse (-1 if the handle is not valid)
+		int _slot;
+	};
+	class ParseResult {
+		friend class ArgumentParser;
+	public:
+		typedef std::pmr::vector<std::string_view> ViewList;
+		// Native form of a value (std::monostate if it is only kept as text)
+		typedef std::variant<std::monostate, int, double, bool> Number;
+		// Values Struct
+		// Values stored for a destination. num holds one native value for
+		// each value (if the arg has a native type), str holds them as text
+		// and is empty for counts. Both are allocated from the result's
+		// memory resource
+		struct Values {
+			typedef std::pmr::polymorphic_allocator<std::byte> allocator_type;
+			Values(allocator_type alloc={});
+			Values(const Values& other, allocator_type alloc={});
+			Values(Values&& other) = default;
+			Values(Values&& other, allocator_type alloc);
+			Values& operator=(const Values& other) = default;
+			Values& operator=(Values&& other) = default;
+			
+			void assign(std::string_view val);
+			int size() const;
+			std::string text(int index) const;
+			
+			ViewList str;
+			std::pmr::vector<Number> num;
+		};
+		// Span Struct
+		// Run of consecutive tokens in the args given to parse(nargs, args).
+		// If the run ends at args[nargs] (as a REMAINDER usually does) and
+		// args is null-terminated like main()'s argv, so is the span
+		struct Span {
+			const char* const* begin() const;
+			const char* const* end() const;
+			int size() const;
+			bool empty() const;
+			
+			const char* const* args;
+			int nargs;
+		};
+		ParseResult(std::pmr::memory_resource* mem=std::pmr::get_default_resource());
+		
+		// Modifiers
+		ParseResult& own();
+		
+		// Accessors
+		bool ok() const;
+		bool help() const;
+		bool version() const;
+		const std::string& message() const;
+		const ArgumentParser& parser() const;
+		ArgumentMap args() const;
+		Handle handle(std::string_view dest) const;
+		const ViewList& values(std::string_view dest) const;
+		const ViewList& values(Handle dest) const;
+		template <typename T>
+		T get(std::string_view dest, int index=0) const{
+			return get<T>(handle(dest), index);
+		}
+		template <typename T>
+		T get(Handle dest, int index=0) const;
+		ArgumentValueList operator[](std::string_view dest) const;
+		ArgumentValueList operator[](Handle dest) const;
+		Span span(std::string_view dest) const;
+		Span span(Handle dest) const;
+		
+		// Binding
+		// store() writes the values of the args bound to variables, and
+		// store(target) also writes those bound to members of target's type.
+		// Args that were not given and have no default are left alone
+		const ParseResult& store() const;
+		template <typename S>
+		const ParseResult& store(S& target) const{
+			return store(&target, &typeid(S));
+		}
+	private:
+		// Binding Struct
+		// Writes the values of a destination into a variable, or into a member
+		// of a struct of the given type (type is nullptr for variables)
+		struct Binding {
+			std::function<void(const ParseResult&, Handle, void*)> write;
+			const std::type_info* type = nullptr;
+		};
+		// Dests Struct
+		// Destination names of a parser and its subparsers. Each name keeps
+		// the index (slot) it was given, which is where its values are stored
+		// in the results of a parse. A lazy subparser adds its names while
+		// other threads may be parsing, so they are written under the lock
+		// and read under a shared lock (insert() expects the lock held)
+		struct Dests {
+			int add(std::string_view name);
+			int insert(std::string_view name);
+			int find(std::string_view name) const;
+			int size() const;
+			
+			mutable std::shared_mutex lock;
+			std::deque<std::string> names;
+			std::unordered_map<std::string_view, int> index;
+			std::vector<Binding> binds;
+		};
+		
+		// Private Modifiers
+		void fail(const ArgumentParser* parser, std::string msg, bool usage=true);
+		std::string_view keep(std::string_view str);
+		std::string_view keep_line(std::string_view line, std::pmr::memory_resource* mem);
+		void prepare(const Dests* dests);
+		void resize();
+		Values& slot(int index);
 		
+		// Private Accessors
+		std::pmr::memory_resource* resource() const;
+		const Values* find(Handle dest) const;
+		const Values& at(Handle dest) const;
+		const ParseResult& store(void* target, const std::type_info* type) const;
+		template <typename T>
+		static constexpr bool bindable = std::is_same_v<T, int> 
+				|| std::is_same_v<T, float> || std::is_same_v<T, double> 
+				|| std::is_same_v<T, bool> || std::is_same_v<T, std::string>;
+		template <typename T>
+		void read(Handle dest, T& var) const{
+			static_assert(bindable<T>, "bound variables must be int, float, "
+					"double, bool or std::string (or a std::vector of them)");
+			const Values* vals = find(dest);
+			if (!vals || vals->size() == 0) return;
+			if (vals->str.size() > 0 && vals->str[0] == NONE) return;
+			var = get<T>(dest);
+		}
+		template <typename T>
+		void read(Handle dest, std::vector<T>& var) const{
+			static_assert(bindable<T>, "bound variables must be int, float, "
+					"double, bool or std::string (or a std::vector of them)");
+			const Values* vals = find(dest);
+			if (!vals) return;
+			if (vals->str.size() > 0 && vals->str[0] == NONE) return;
+			var.resize(vals->size());
+			for (int i=0; i<vals->size(); i++) var[i] = get<T>(dest, i);
+		}
+		
+		// Status
+		enum class Status {
+			Ok,
+			Error,
+			Help,
+			Version
+		};
+		
+		// _status			= Enum storing how the parse ended
+		// _msg				= Error message (or version string for Version)
+		// _parser			= Parser that ended the parse (the base parser or
+		// 						one of its subparsers)
+		// _usage			= Bool storing whether the usage should be printed
+		// 						with the error message
+		// _dests			= Destination names of the parser (nullptr until
+		// 						the parse starts)
+		// _vals			= Parsed values, indexed by the slot of their
+		// 						destination. The text is viewed in the parsed
+		// 						argv, the parser's schema, _owned or _lines
+		// _found			= Depth of the parser that set each slot (1 for the
+		// 						base parser, 2 for its subparser...), 0 if it
+		// 						was not set (so that it is part of the
+		// 						namespace)
+		// _depth			= Depth of the parser that is parsing into the
+		// 						result
+		// _others			= Tokens a subparser left for its base parser
+		// _argv			= Args given to parse(nargs, args) (nullptr if the
+		// 						values do not view them)
+		// _argc			= Number of args in _argv
+		// _owned			= Strings the result owns (values copied by own()),
+		// 						shared with subparser results
+		// _lines			= Lines read from response files, allocated from
+		// 						the resource the files were read with
+		// 						(_vals, _found, _others and _owned allocate
+		// 						from the memory resource given to the
+		// 						constructor)
+		Status _status;
+		std::string _msg;
+		const ArgumentParser* _parser;
+		bool _usage;
+		const Dests* _dests;
+		std::pmr::vector<Values> _vals;
+		std::pmr::vector<int> _found;
+		int _depth;
+		ViewList _others;
+		const char* const* _argv;
+		int _argc;
+		std::shared_ptr<std::pmr::deque<std::pmr::string>> _owned, _lines;
+	};
 	
 	class ArgumentParser {
+		friend class ParseResult;
 		friend class SubparserList;
+		friend class PushParser;
 	private:
 		// Private Enums 
 		const int HELP_INDENT_MAX = 24;
@@ -300,6 +814,67 @@ namespace argparse{
 			Version,
 			Help
 		};
+		// ParseState Struct
+		// Values collected for each argument during a single parse, so that
+		// the arguments themselves are never modified by parsing
+		class Argument;
+		struct ParseState {
+			struct Slot {
+				// found		= Bool storing whether the arg was found
+				// val			= Values stored by the arg
+				Slot(std::pmr::memory_resource* mem);
+				bool found;
+				ParseResult::Values val;
+			};
+			ParseState(const ArgumentParser& parser, std::pmr::memory_resource* mem);
+			
+			// opt				= Slots for each arg in _optlist
+			// pos				= Slots for each arg in _arglist
+			std::pmr::vector<Slot> opt, pos;
+		};
+		// HelpCache Struct
+		// Rendered usage and help strings. The first thread that needs them
+		// renders them under the lock, and valid is cleared whenever the
+		// parser changes. Copies start out empty, since the lock cannot be
+		// copied (and the copy may be changed). usage and help view either
+		// the rendered strings or a precompiled HelpSnapshot
+		struct HelpCache {
+			HelpCache();
+			HelpCache(const HelpCache& other);
+			HelpCache& operator=(const HelpCache& other);
+			
+			std::mutex lock;
+			std::atomic<bool> valid;
+			std::string rendered_usage, rendered_help;
+			std::string_view usage, help;
+		};
+		// Factory Struct
+		// Builds a lazy subparser (see SubparserList::add_parser()). The
+		// first thread that needs the subparser builds and freezes it under
+		// the lock, and built is set once it is done. Copies keep the
+		// callback and whether it has run
+		struct Factory {
+			Factory();
+			Factory(const Factory& other);
+			Factory& operator=(const Factory& other);
+			
+			std::function<void(ArgumentParser&)> build;
+			std::mutex lock;
+			std::atomic<bool> built;
+		};
+		// TrieNode Struct
+		// Node of the prefix trie over long option names
+		struct TrieNode {
+			// exact		= Index in _optlist of the optarg named by the
+			// 					prefix (-1 if there is none)
+			// unique		= Index in _optlist of the only optarg whose name
+			// 					begins with the prefix (-1 if there is none,
+			// 					-2 if there are several)
+			// first		= Index of the node's first edge in _longedges
+			// nedges		= Number of edges (children) of the node
+			int exact, unique;
+			int first, nedges;
+		};
 		// Argument Class 
 		class Argument {
 			friend class ArgumentParser;
@@ -325,18 +900,47 @@ namespace argparse{
 			Argument& constant(std::string con, char delim=',');
 			Argument& count();
 			
+			// Binding
+			// The values of the arg are written into var (or into the member
+			// of the struct given to ParseResult::store()) when the result of
+			// a parse is stored
+			template <typename T>
+			Argument& bind(T& var){
+				_bind.write = [&var](const ParseResult& result, Handle dest, void*){
+					result.read(dest, var);
+				};
+				_bind.type = nullptr;
+				return *this;
+			}
+			template <typename S, typename T>
+			Argument& bind(T S::* member){
+				_bind.write = [member](const ParseResult& result, Handle dest, void* target){
+					result.read(dest, static_cast<S*>(target)->*member);
+				};
+				_bind.type = &typeid(S);
+				return *this;
+			}
+			
+			// Conversions
+			operator Handle() const;
+			
 		private:
 			// Error Handling
 			std::string error(std::string msg="") const;
-			std::string error(int code, std::string msg="") const;
+			std::string error(int code, std::string_view msg="") const;
 			
 			// Modifiers
-			int set(std::string value, bool has_digit_opt,	bool careful=true);
+			Argument& changed();
 			void add_choice(std::string choice);
+			void load_values();
 			
 			// Accessors
-			const std::string& operator[](int index) const;
-			int size() const;
+			int set(ParseState::Slot& slot, std::string_view value, 
+					bool has_digit_opt, bool careful=true) const;
+			int set(ParseState::Slot& slot, const std::string_view* begin, 
+					const std::string_view* end, std::string_view& bad) const;
+			bool convert(std::string_view value, ParseResult::Number& num) const;
+			bool valid_choice(std::string_view value) const;
 			std::string get_id() const;
 			std::string get_help_id(HelpFormatter format) const;
 			std::string get_usage(HelpFormatter format) const;
@@ -345,6 +949,7 @@ namespace argparse{
 			
 			// Helpers
 			std::string trim(std::string str) const;
+			void add_memory(MemoryStats& stats) const;
 			
 			// _type				= Enum storing the type of argument (optarg or 
 			// 							posarg)
@@ -372,18 +977,30 @@ namespace argparse{
 			std::string _sname, _lname, _dest;
 			std::string _help, _version;
 			
-			// _found				= Bool storing whether the arg was found in 
-			// 							ArgumentParser::parse_args()
+			// _parser				= Parser the arg was added to, which the chain
+			// 							modifiers unfreeze (null if it has none)
+			// _dests				= Destination names of the parser the arg was
+			// 							added to
+			// _slot				= Slot of _dest in _dests (set when the parser
+			// 							is frozen, -1 if _dest is empty)
+			ArgumentParser* _parser;
+			ParseResult::Dests* _dests;
+			int _slot;
+			
+			// _bind				= Binding that writes the stored values into a
+			// 							variable or struct member (write is empty
+			// 							if the arg is not bound)
+			ParseResult::Binding _bind;
+			
 			// _required			= Bool storing whether the arg is required
 			// _subparser			= Bool storing whether the arg chooses the
 			// 							subparser for the program
 			// _has_default			= Bool storing whether the arg has a default
 			// _override_metavar	= Bool storing whether the arg has a custom 
 			// 							metavar
-			bool _found, _required, _subparser;
+			bool _required, _subparser;
 			bool _has_default, _override_metavar;
 			
-			// _val					= Vector of values stored by the arg
 			// _metavar				= Vector of the "Metavariable" of the arg
 			// 							This is what is shown in usage/help messages
 			// _def					= Vector of default values given if the arg is 
@@ -394,7 +1011,18 @@ namespace argparse{
 			// 							(e.g. boolean flag that stores the const
 			// 							value when given or the default when 
 			// 							missing)
-			std::vector<std::string> _val, _metavar, _def, _choices, _const;
+			std::vector<std::string> _metavar, _def, _choices, _const;
+			
+			// _choiceidx			= Map of the hash of each choice to its index
+			// 							in _choices (so that values can be checked
+			// 							without copying them)
+			std::unordered_multimap<size_t, int> _choiceidx;
+			
+			// _defval				= _def as stored values (set when the parser
+			// 							is frozen)
+			// _constval			= _const as stored values (set when the 
+			// 							parser is frozen)
+			ParseResult::Values _defval, _constval;
 		};
 	public:
 		class SubparserList{
@@ -410,26 +1038,44 @@ namespace argparse{
 			SubparserList& required(bool required=true);
 			
 			// Modifiers
-			ArgumentParser& add_parser(std::string cmd);
+			// (aliases are other names of the command, as in python)
+			ArgumentParser& add_parser(std::string cmd, std::vector<std::string> aliases={});
+			// Adds a subcommand whose parser is only built (by passing it to
+			// build) when the command is parsed or its own help is needed
+			SubparserList& add_parser(std::string cmd, std::string help, 
+					std::function<void(ArgumentParser&)> build, 
+					std::vector<std::string> aliases={});
 		private:
 			SubparserList();
 			
 			// Private Modifiers
 			void add(ArgumentParser* parser);
+			void load_commands();
 			
 			// Accessors
 			const ArgumentParser& operator[](int index) const;
 			int size() const;
 			bool valid() const;
+			int find(std::string_view cmd) const;
+			int match(std::string_view cmd) const;
+			std::string matches(std::string_view cmd) const;
 			
 			// _parser			= Pointer to the parser one step above this
 			// 						collection of subparsers
-			// _subparsers		= Vector of the subparsers
+			// _subparsers		= Deque of the subparsers (so that adding one
+			// 						neither moves nor copies the others)
 			// _arg				= Index of the subparser argument in the base
 			// 						parser's positional argument list
+			// _commands		= Index in _subparsers of the subparser for each
+			// 						command and alias
+			// _sorted			= Commands and aliases in order with the index
+			// 						of their subparser, for prefix matching
+			// 						(loaded when the base parser is frozen)
 			ArgumentParser* _parser;
-			std::vector<ArgumentParser> _subparsers;
+			std::deque<ArgumentParser> _subparsers;
 			int _arg;
+			std::unordered_map<std::string, int> _commands;
+			std::vector<std::pair<std::string, int>> _sorted;
 			
 			// _title			= Title of the subparser arg group
 			// 						(if empty, the help is added to posargs)
@@ -462,6 +1108,20 @@ namespace argparse{
 		Argument& add_argument(std::string name);
 		Argument& add_argument(std::string sname, std::string lname);
 		Argument& add_argument(std::string name);
+		// Adds a table of arguments, reserving space for all of them first
+		ArgumentParser& add_arguments(const std::vector<ArgumentSpec>& specs);
+		
+		// Adds an optarg bound to a member of a struct, typed from the member
+		// (std::vector members take '*' values). A name without leading dashes
+		// becomes --name, with underscores replaced by dashes
+		template <typename S, typename T>
+		Argument& add_field(T S::* member, std::string name){
+			return add_field_argument<T>(field_name(name)).bind(member);
+		}
+		template <typename S, typename T>
+		Argument& add_field(std::vector<T> S::* member, std::string name){
+			return add_field_argument<T>(field_name(name)).nargs('*').bind(member);
+		}
 		
 		SubparserList& add_subparsers();
 		
@@ -475,7 +1135,7 @@ namespace argparse{
 		//prefix_chars()
 		ArgumentParser& fromfile_prefix_chars(std::string prefix);
 		ArgumentParser& argument_default(std::string def);
-		//allow_abrev()
+		ArgumentParser& allow_abbrev(bool allow_abbrev=true);
 		ArgumentParser& conflict_handler(std::string name);
 		ArgumentParser& add_help(bool add_help);
 		//exit_on_error()
@@ -484,28 +1144,92 @@ namespace argparse{
 		ArgumentParser& help(std::string help);
 
 		ArgumentParser& set_linecap(int linecap);
+		ArgumentParser& freeze();
+		
+		// Stats of this parser and its subparsers (see ParserStats)
+		const ParserStats& stats() const;
+		ArgumentParser& reset_stats();
+		// Heap memory held by this parser and its subparsers
+		MemoryStats memory() const;
+		
+		// Serves the help and usage of this parser and its subparsers from
+		// snapshots whose program name, formatter and linecap match, instead
+		// of rendering them. The snapshots must outlive the parser
+		ArgumentParser& precompiled_help(const HelpSnapshot* snapshots, int count);
+		template <int N>
+		ArgumentParser& precompiled_help(const HelpSnapshot (&snapshots)[N]){
+			return precompiled_help(snapshots, N);
+		}
+		// Writes the help of this parser and its subparsers at each linecap
+		// as a C++ table of HelpSnapshots named name. When the library is
+		// built with ARGPARSE_SNAPSHOT_BUILD, parse_args() does this (and
+		// exits) if ARGPARSE_HELP_SNAPSHOT names the output file
+		void write_help_snapshot(std::ostream& out, std::string name, 
+				const std::vector<int>& linecaps);
 		
 		// Accessors
 		std::string get_prog() const;
+		bool frozen() const;
 		ArgumentValueList get_default(std::string name) const;
 		std::string format_usage();
+		std::string format_usage() const;
 		std::string format_help();
+		std::string format_help() const;
 		void print_usage(std::ostream& out=std::cout);
+		void print_usage(std::ostream& out=std::cout) const;
 		void print_help(std::ostream& out=std::cout);
+		void print_help(std::ostream& out=std::cout) const;
 		
 		// Parse
 		ArgumentMap parse_args(std::vector<std::string> argv = {});
+		ParseResult parse(const std::vector<std::string>& argv, 
+				std::pmr::memory_resource* mem=std::pmr::get_default_resource()) const;
+		ParseResult parse(int nargs, const char* const* args, 
+				std::pmr::memory_resource* mem=std::pmr::get_default_resource()) const;
+		std::vector<ParseResult> parse_many(
+				const std::vector<std::vector<std::string>>& batch, 
+				int nthreads=0) const;
 		
 	private:
+		// Subparser of base for the command cmd (it shares the base's
+		// destinations and stats, and does not keep argv)
+		ArgumentParser(const ArgumentParser& base, std::string cmd);
+		
 		// Private Helpers
 		void check_conflict(const Argument& arg, ArgType type);
+		void load_names();
+		std::string field_name(std::string name) const;
+		template <typename T>
+		Argument& add_field_argument(std::string name){
+			if constexpr (std::is_same_v<T, std::string>) return add_argument(name);
+			else return add_argument<T>(name);
+		}
 		inline bool valid_value(std::string val) const;
 		
-		void load_helpstring();
-		std::vector<std::string> read_args_from_files(std::vector<std::string> args);
-		bool find_arg(const Argument& arg, std::string given) const;
-		bool contains(std::string given, char sname, bool flag=false) const;
+		void parse_into(ParseResult& result, const std::string_view* argv, 
+				const std::string_view* end, int base_req_posargs) const;
+		void load_helpstring() const;
+		const HelpCache& helpstrings() const;
+		void snapshot_help(std::ostream& out, const std::vector<int>& linecaps);
+		void load_index();
+		void load_subparser_progs();
+		const ArgumentParser& built() const;
+		void build_all() const;
+		std::pmr::vector<std::string_view> read_args_from_files(
+				const std::string_view* first, const std::string_view* last,
+				ParseResult& result, std::pmr::memory_resource* mem) const;
+		int load_trie(const std::vector<std::pair<std::string_view, int>>& names,
+				int begin, int end, int depth);
+		int match_long(std::string_view name) const;
+		std::string ambiguous_option(std::string_view name) const;
+		void store_flag(const Argument& flag, ParseState::Slot& slot) const;
+		void store_values(const Argument& arg, const ParseState::Slot& slot,
+				ParseResult& result) const;
+		void push_level(PushParser& push) const;
+		void add_memory(MemoryStats& stats) const;
+		void push_token(PushParser& push, std::string_view token) const;
 		
+		std::string get_subparser_name() const;
 		std::string get_subparser_help(int linecap, int indent, 
 				HelpFormatter format) const;
 		
@@ -519,18 +1243,54 @@ namespace argparse{
 		
 		// _optlist			= Vector of optional arguments (optargs)
 		// _arglist			= Vector of positional arguments (posargs)
-		// _helpargs		= Vector of flags that print help
-		// _opthelp			= Formatted help message for optargs
-		// _arghelp			= Formatted help message for posargs
+		// _helpargs		= Indices of the optargs that print help
 		// _none_str		= String value that args are assigned
 		// 						if they are not filled
 		// 						(default: NONE)
 		// _defaults		= Map of default values for argument parsing
+		// _defslots		= Slot of each destination in _defaults, with a
+		// 						view of its value (set when the parser is
+		// 						frozen)
+		// _dests			= Destination names of the parser, shared with its
+		// 						subparsers (and the parsers copied from it)
 		// _req_posargs		= Number of required posargs
-		std::vector<Argument> _optlist, _arglist, _helpargs;
-		std::string _opthelp, _arghelp, _none_str;
+		// _first_collection= Index of the first posarg that takes '*' or '+'
+		// 						(-1 if there is none)
+		// _remainder_start	= Number of posarg values before the REMAINDER
+		// 						posarg, after which every token belongs to it
+		// 						(-1 if there is none, or if the posargs before
+		// 						it do not take a fixed number of values)
+		std::vector<Argument> _optlist, _arglist;
+		std::vector<int> _helpargs;
+		std::string _none_str;
 		std::map<std::string, std::string> _defaults;
-		int _req_posargs;
+		std::vector<std::pair<int, std::string_view>> _defslots;
+		std::shared_ptr<ParseResult::Dests> _dests;
+		int _req_posargs, _first_collection, _remainder_start;
+		
+		// _stats			= Phase stats, shared with the subparsers
+		std::shared_ptr<ParserStats> _stats;
+		
+		// _shortidx		= Table of the index in _optlist of each short option
+		// 						character (-1 if there is none)
+		// _longidx		= Open-addressed hash table of the long option names,
+		// 						as (hash, index in _optlist) with -1 for empty
+		// 						entries. Its size is a power of two
+		// _longtrie		= Nodes of the prefix trie over long option names
+		// 						(node 0 is the root), for abbreviations
+		// _longedges		= Edges of the trie as (character, child node), with
+		// 						the edges of each node stored together
+		// _optnames		= Index in _optlist of the optarg holding each option
+		// 						string, kept up to date as args are added
+		// _frozen			= Bool storing whether the schema has been frozen
+		// 						(help added, indices built) since it or its
+		// 						help last changed
+		std::array<int, 256> _shortidx;
+		std::vector<std::pair<size_t, int>> _longidx;
+		std::vector<TrieNode> _longtrie;
+		std::vector<std::pair<char, int>> _longedges;
+		std::unordered_map<std::string, int> _optnames;
+		bool _frozen;
 		
 		// _format			= Enum storing how the help screen (and usage) 
 		// 						is formatted
@@ -538,53 +1298,141 @@ namespace argparse{
 		// 						set to resolve
 		// _fromfile_prefix = String containing the prefix characters that denote
 		// 						desired input from a file
+		// _allow_abbrev	= Bool storing whether long options can be
+		// 						abbreviated (default: true)
 		HelpFormatter _format;
-		bool _resolve;
+		bool _resolve, _allow_abbrev;
 		std::string _fromfile_prefix;
 		
 		// _prog			= Name of the program
 		// _desc			= Description of the program
 		// _epilog			= Post-help description of the program
-		// _usage			= Usage string
-		// _help_indent		= Length of the indent before help strings of args
+		// _usage			= Usage string (only used if it has been given a
+		// 						custom value)
 		// _linecap			= Width of the terminal screen (-2)
-		// _preusage_len	= Length of the initial string before the program usage
-		// _usage_line_len	= Length of the current line in the usage string
+		// _helpcache		= Usage and help strings, rendered the first time
+		// 						they are needed after the parser (or its
+		// 						linecap) last changed
+		// _snapshots		= Precompiled help of the parser and its
+		// 						subparsers (nullptr if there is none)
+		// _nsnapshots		= Number of entries in _snapshots
 		std::string _prog, _desc, _epilog, _usage;
-		int _help_indent, _linecap;
-		int _preusage_len, _usage_line_len;
+		int _linecap;
+		mutable HelpCache _helpcache;
+		const HelpSnapshot* _snapshots;
+		int _nsnapshots;
 		
 		// _parsed			= Bool storing whether arguments have been parsed
 		// 						(stored for error-printing purposes)
 		// _has_digit_opt	= Bool storing whether there is an optarg that
 		// 						looks like a negative number
-		// _multiline_usage	= Bool storing whether the usage string is multiple 
-		// 						lines (stored for posarg usage formatting)
 		// _override_usage	= Bool storing whether usage has been given a
 		// 						custom value
 		// _override_prog	= Bool storing whether the program name has been given
 		// 						a custom value
 		// _add_help		= Bool storing whether the -h/--help arg
 		// 						should be added (default: true)
-		bool _parsed, _has_digit_opt, _multiline_usage;
+		bool _parsed, _has_digit_opt;
 		bool _override_usage, _override_prog, _add_help, _added_help;
 		
 		// _subparser		= Bool storing whether the parser is a subparser
 		// _subparser_index = Index for the subparser argument in the positional
 		// 						argument list
-		// _base_req_posargs= Number of required positional arguments from the base
-		// 						parser (set to 0 if the parser is not a subparser)
 		// _subparser_cmd	= Name of the subparser command (empty if the parser
 		// 						is not a subparser)
 		// _subparser_help	= Help string for the subparser (empty if the parser
 		// 						is not a subparser)
-		// _subhelp			= Formatted help message for the subparser arg group
+		// _subparser_aliases = Other names of the subparser command
 		// _subparsers		= SubparserList object that allows user to format
 		// 						the subparser group help message and add parsers
+		// _factory			= Builder of a lazy subparser (empty otherwise)
 		bool _subparser;
-		int _subparser_index, _base_req_posargs;
-		std::string _subparser_cmd, _subparser_help, _subhelp;
+		int _subparser_index;
+		std::string _subparser_cmd, _subparser_help;
+		std::vector<std::string> _subparser_aliases;
 		SubparserList _subparsers;
+		mutable Factory _factory;
+	};
+	// PushParser Class
+	// Parses a command line given a token at a time (e.g. as it is read from
+	// a console or a socket). Each token is matched as it is pushed, so a
+	// command that can no longer be valid is reported at once, and result()
+	// parses the tokens a single time at the end. Positional values are only
+	// counted until then (they are assigned and checked by result())
+	class PushParser {
+		friend class ArgumentParser;
+	public:
+		enum class Status {
+			Complete,
+			NeedsValues,
+			Invalid
+		};
+		
+		// The parser must be frozen, and must outlive the PushParser
+		explicit PushParser(const ArgumentParser& parser);
+		PushParser(const PushParser& other) = delete;
+		PushParser& operator=(const PushParser& other) = delete;
+		
+		// Modifiers
+		Status push(std::string_view token);
+		void reset();
+		
+		// Accessors
+		Status status() const;
+		int needed() const;
+		const std::string& message() const;
+		int size() const;
+		ParseResult result(std::pmr::memory_resource* mem=std::pmr::get_default_resource()) const;
+	private:
+		// Level Struct
+		// Matching state within one parser (the base parser, or a subparser
+		// selected by a subcommand)
+		struct Level {
+			// parser		= Parser that the tokens are matched against
+			// found		= Bool storing whether each optarg has been given
+			// missing		= Number of required optargs not given yet
+			// posargs		= Number of positional values given
+			// min_posargs	= Number of positional values the parser needs
+			// max_posargs	= Number of positional values the parser takes
+			// 					(-1 if there is no limit)
+			// pending		= Index of the optarg taking the next values (-1 if
+			// 					there is none)
+			// pending_count= Number of values given to the pending optarg
+			// pending_min	= Number of values the pending optarg needs
+			// only_posargs	= Bool storing whether "--" has been given
+			const ArgumentParser* parser;
+			std::vector<bool> found;
+			int missing, posargs, min_posargs, max_posargs;
+			int pending, pending_count, pending_min;
+			bool only_posargs;
+		};
+		
+		void fail(std::string msg);
+		void unrecognized(std::string_view token);
+		
+		// _parser			= Base parser
+		// _levels			= State of the base parser, then of each subparser
+		// 						selected so far (the last one takes the tokens)
+		// _tokens			= Tokens pushed so far (the result views them)
+		// _args			= Program name and the tokens, as an argv
+		// _slot			= Scratch slot that values are checked with
+		// _msg				= Error message, once the command is invalid
+		// _unrecognized	= Tokens that match no argument (they make the
+		// 						command invalid, unless help is asked for)
+		const ArgumentParser* _parser;
+		std::vector<Level> _levels;
+		std::deque<std::string> _tokens;
+		std::vector<const char*> _args;
+		ArgumentParser::ParseState::Slot _slot;
+		std::string _msg, _unrecognized;
+		
+		// _invalid			= Bool storing whether a token has made the
+		// 						command invalid
+		// _help			= Bool storing whether help or the version has been
+		// 						asked for
+		// _remainder		= Bool storing whether a REMAINDER argument takes
+		// 						every token left
+		bool _invalid, _help, _remainder;
 	};
 };
 
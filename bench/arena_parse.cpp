@@ -0,0 +1,43 @@
+// Compares parsing a typical command line with results allocated on the heap
+// and with results allocated from a monotonic arena that is released after
+// every parse.
+#include "argparse.h"
+#include <chrono>
+#include <cstdio>
+
+int main(){
+	char prog[] = "bench";
+	char* argv[] = {prog, nullptr};
+	argparse::ArgumentParser parser(1, argv);
+	parser.add_argument<int>("-n", "--num");
+	parser.add_argument<double>("--rate");
+	parser.add_argument<bool>("-v").count();
+	parser.add_argument("-I", "--include").nargs('*');
+	parser.add_argument("--mode").choices("fast,safe,debug").def("safe");
+	parser.add_argument("input");
+	for (int i=0; i<20; i++)
+		parser.add_argument("--opt" + std::to_string(i)).def("x");
+	parser.freeze();
+	const char* args[] = {"bench", "-n", "5", "--rate", "0.5", "-vvv", "-I", "a", "b",
+		"c", "--mode", "fast", "input.txt"};
+	const int nargs = sizeof(args)/sizeof(args[0]), reps = 200000;
+
+	volatile int sink = 0;
+	auto start = std::chrono::steady_clock::now();
+	for (int r=0; r<reps; r++)
+		sink = sink + parser.parse(nargs, args).get<int>("num");
+	auto mid = std::chrono::steady_clock::now();
+	alignas(std::max_align_t) static char buffer[16384];
+	std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer));
+	for (int r=0; r<reps; r++){
+		sink = sink + parser.parse(nargs, args, &arena).get<int>("num");
+		arena.release();
+	}
+	auto stop = std::chrono::steady_clock::now();
+	std::printf("%-10s %s\n", "resource", "ns/parse");
+	std::printf("%-10s %.1f\n", "heap",
+			std::chrono::duration<double, std::nano>(mid-start).count()/reps);
+	std::printf("%-10s %.1f\n", "arena",
+			std::chrono::duration<double, std::nano>(stop-mid).count()/reps);
+	return 0;
+}
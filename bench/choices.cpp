@@ -0,0 +1,39 @@
+// Measures registering a large set of choices and validating values against
+// it. Registration should grow linearly with the number of choices, and the
+// cost of validating a value should stay flat.
+#include "argparse.h"
+#include <chrono>
+#include <cstdio>
+
+int main(){
+	char prog[] = "bench";
+	char* argv[] = {prog, nullptr};
+	const int nvalues = 1000, reps = 20;
+	std::printf("%-10s %-14s %s\n", "choices", "register ms", "ns/value");
+	for (int nchoices : {10, 1000, 10000, 100000}){
+		std::string list;
+		for (int i=0; i<nchoices; i++)
+			list += (i? "," : "") + std::string("region-") + std::to_string(i);
+
+		argparse::ArgumentParser parser(1, argv);
+		auto start = std::chrono::steady_clock::now();
+		parser.add_argument("--region").nargs('+').choices(list);
+		auto mid = std::chrono::steady_clock::now();
+		parser.freeze();
+
+		std::vector<std::string> args{"--region"}, empty{"--region", "region-0"};
+		for (int i=0; i<nvalues; i++)
+			args.push_back("region-" + std::to_string((i*7919) % nchoices));
+		auto begin = std::chrono::steady_clock::now();
+		for (int r=0; r<reps; r++) parser.parse(empty);
+		auto fixed_end = std::chrono::steady_clock::now();
+		for (int r=0; r<reps; r++) parser.parse(args);
+		auto stop = std::chrono::steady_clock::now();
+		double fixed = std::chrono::duration<double, std::nano>(fixed_end-begin).count();
+		double total = std::chrono::duration<double, std::nano>(stop-fixed_end).count();
+		std::printf("%-10d %-14.2f %.1f\n", nchoices,
+				std::chrono::duration<double, std::milli>(mid-start).count(),
+				(total-fixed)/reps/(nvalues-1));
+	}
+	return 0;
+}
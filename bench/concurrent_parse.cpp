@@ -0,0 +1,62 @@
+// Parses the same command lines from several threads against one shared,
+// frozen parser and reports the total throughput for each thread count.
+// Every result is checked against a single-threaded reference, so this also
+// serves as a stress test (build with -fsanitize=thread to look for races).
+#include "argparse.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+int main(){
+	char prog[] = "bench";
+	char* argv[] = {prog, nullptr};
+	argparse::ArgumentParser parser(1, argv);
+	for (int i=0; i<100; i++)
+		parser.add_argument<int>("--opt" + std::to_string(i)).def("0");
+	parser.add_argument<bool>("-v", "--verbose").count();
+	parser.add_argument("-o", "--output").def("out.txt");
+	auto& subs = parser.add_subparsers().dest("cmd");
+	auto& run = subs.add_parser("run");
+	run.add_argument<double>("--scale").def("1.0");
+	run.add_argument("targets").nargs("+");
+	parser.freeze();
+	
+	std::vector<std::vector<std::string>> lines;
+	for (int i=0; i<64; i++){
+		std::vector<std::string> line{"-vv", "--opt" + std::to_string(i), std::to_string(i)};
+		if (i % 2) line.push_back("--output=file" + std::to_string(i));
+		line.insert(line.end(), {"run", "--scale", "2.5", "a", "b"});
+		lines.push_back(line);
+	}
+	std::vector<std::string> expected;
+	for (const auto& line : lines)
+		expected.push_back(argparse::format_args(parser.parse(line).args()));
+	
+	const int parses = 20000;
+	std::printf("%-10s %-10s %s\n", "threads", "parses", "parses/s");
+	for (int nthreads : {1, 2, 4, 8}){
+		std::atomic<int> mismatches(0);
+		std::vector<std::thread> threads;
+		auto start = std::chrono::steady_clock::now();
+		for (int t=0; t<nthreads; t++){
+			threads.emplace_back([&, t](){
+				for (int i=0; i<parses/nthreads; i++){
+					int k = (i + t) % lines.size();
+					auto result = parser.parse(lines[k]);
+					if (!result.ok() || argparse::format_args(result.args()) != expected[k])
+						mismatches++;
+				}
+			});
+		}
+		for (auto& thread : threads) thread.join();
+		auto stop = std::chrono::steady_clock::now();
+		double s = std::chrono::duration<double>(stop-start).count();
+		std::printf("%-10d %-10d %.0f\n", nthreads, parses, parses/s);
+		if (mismatches){
+			std::printf("error: %d results differed from the reference\n", (int)mismatches);
+			return 1;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,39 @@
+// Measures reading values from a parse result by name through the
+// ArgumentMap view, by name with get<T>(), and through the handle returned
+// by add_argument(), as the number of destinations grows.
+#include "argparse.h"
+#include <chrono>
+#include <cstdio>
+
+int main(){
+	char prog[] = "bench";
+	char* argv[] = {prog, nullptr};
+	const int reads = 200000;
+	std::printf("%-10s %-10s %-10s %s\n", "options", "map ns", "name ns", "handle ns");
+	for (int nopts : {10, 100, 1000}){
+		argparse::ArgumentParser parser(1, argv);
+		std::vector<argparse::Handle> handles;
+		std::vector<std::string> names;
+		for (int i=0; i<nopts; i++){
+			names.push_back("option_" + std::to_string(i));
+			handles.push_back(parser.add_argument<int>("--option-" + std::to_string(i)).def(std::to_string(i)));
+		}
+		parser.freeze();
+		auto result = parser.parse(std::vector<std::string>{});
+		argparse::ArgumentMap args = result.args();
+
+		volatile int sink = 0;
+		auto start = std::chrono::steady_clock::now();
+		for (int i=0; i<reads; i++) sink = sink + (int)args[names[(i*7919) % nopts]];
+		auto mid = std::chrono::steady_clock::now();
+		for (int i=0; i<reads; i++) sink = sink + result.get<int>(names[(i*7919) % nopts]);
+		auto mid2 = std::chrono::steady_clock::now();
+		for (int i=0; i<reads; i++) sink = sink + result.get<int>(handles[(i*7919) % nopts]);
+		auto stop = std::chrono::steady_clock::now();
+		std::printf("%-10d %-10.1f %-10.1f %.1f\n", nopts,
+				std::chrono::duration<double, std::nano>(mid-start).count()/reads,
+				std::chrono::duration<double, std::nano>(mid2-mid).count()/reads,
+				std::chrono::duration<double, std::nano>(stop-mid2).count()/reads);
+	}
+	return 0;
+}
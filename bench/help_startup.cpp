@@ -0,0 +1,37 @@
+// Measures freezing and parsing with a large CLI (thousands of options and
+// hundreds of subcommands) now that help text is only rendered on request,
+// and the cost of the first format_help() against the cached ones after it.
+#include "argparse.h"
+#include <chrono>
+#include <cstdio>
+
+int main(){
+	char prog[] = "bench";
+	char* argv[] = {prog, nullptr};
+	std::printf("%-8s %-8s %-12s %-12s %-14s %s\n", "options", "subcmds",
+			"freeze us", "parse us", "first help us", "cached help ns");
+	for (int nopts : {100, 1000, 5000}){
+		const int nsubs = nopts / 10, reps = 1000;
+		auto start = std::chrono::steady_clock::now();
+		argparse::ArgumentParser parser(1, argv);
+		for (int i=0; i<nopts; i++)
+			parser.add_argument("--option-" + std::to_string(i)).help("option number " + std::to_string(i));
+		auto& subparsers = parser.add_subparsers().dest("cmd");
+		for (int i=0; i<nsubs; i++)
+			subparsers.add_parser("cmd" + std::to_string(i)).help("subcommand " + std::to_string(i));
+		parser.freeze();
+		auto frozen = std::chrono::steady_clock::now();
+		auto result = parser.parse({"--option-1", "x", "cmd0"});
+		auto parsed = std::chrono::steady_clock::now();
+		volatile size_t sink = parser.format_help().size();
+		auto helped = std::chrono::steady_clock::now();
+		for (int r=0; r<reps; r++) sink = sink + parser.format_help().size();
+		auto stop = std::chrono::steady_clock::now();
+		std::printf("%-8d %-8d %-12.1f %-12.1f %-14.1f %.1f\n", nopts, nsubs,
+				std::chrono::duration<double, std::micro>(frozen-start).count(),
+				std::chrono::duration<double, std::micro>(parsed-frozen).count(),
+				std::chrono::duration<double, std::micro>(helped-parsed).count(),
+				std::chrono::duration<double, std::nano>(stop-helped).count()/reps);
+	}
+	return 0;
+}
@@ -0,0 +1,41 @@
+// Measures the per-token cost of resolving abbreviated long options (e.g.
+// --option-42-v for --option-42-value) as the number of options grows.
+// Lookups walk the prefix trie, so this should depend only on the length of
+// the token.
+#include "argparse.h"
+#include <chrono>
+#include <cstdio>
+
+int main(){
+	char prog[] = "bench";
+	char* argv[] = {prog, nullptr};
+	const int ntokens = 1000, reps = 20;
+	std::printf("%-10s %-10s %-12s %s\n", "options", "tokens", "exact ns", "abbrev ns");
+	for (int nopts : {10, 100, 1000, 5000}){
+		argparse::ArgumentParser parser(1, argv);
+		for (int i=0; i<nopts; i++)
+			parser.add_argument<int>("--option-" + std::to_string(i) + "-value");
+		parser.freeze();
+
+		std::vector<std::string> exact, abbrev, empty{"--option-0-value", "0"};
+		for (int i=0; i<ntokens; i++){
+			std::string name = "--option-" + std::to_string((i*7919) % nopts) + "-v";
+			exact.push_back(name + "alue");
+			exact.push_back(std::to_string(i));
+			abbrev.push_back(name);
+			abbrev.push_back(std::to_string(i));
+		}
+
+		double ns[3];
+		const std::vector<std::string>* inputs[3] = {&empty, &exact, &abbrev};
+		for (int k=0; k<3; k++){
+			auto start = std::chrono::steady_clock::now();
+			for (int r=0; r<reps; r++) parser.parse(*inputs[k]);
+			auto stop = std::chrono::steady_clock::now();
+			ns[k] = std::chrono::duration<double, std::nano>(stop-start).count();
+		}
+		std::printf("%-10d %-10d %-12.1f %.1f\n", nopts, ntokens,
+				(ns[1]-ns[0])/reps/(ntokens-1), (ns[2]-ns[0])/reps/(ntokens-1));
+	}
+	return 0;
+}
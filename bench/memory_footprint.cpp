@@ -0,0 +1,43 @@
+// Reports the heap memory held by a large schema (5k options and 200
+// subcommands), and the allocations made by a parse of a typical command
+// line and of a response file, counted with a CountingResource.
+#include "argparse.h"
+#include <cstdio>
+
+int main(){
+	char prog[] = "bench";
+	char* argv[] = {prog, nullptr};
+	argparse::ArgumentParser parser(1, argv);
+	parser.fromfile_prefix_chars("@");
+	for (int i=0; i<5000; i++)
+		parser.add_argument<int>("--option-" + std::to_string(i)).help("option number " + std::to_string(i));
+	parser.add_argument("-I", "--include").nargs('*');
+	auto& subparsers = parser.add_subparsers().dest("cmd");
+	for (int i=0; i<200; i++){
+		auto& sub = subparsers.add_parser("cmd" + std::to_string(i));
+		sub.help("subcommand " + std::to_string(i));
+		sub.add_argument("--flag" + std::to_string(i)).choices("a,b,c");
+	}
+	parser.freeze();
+	parser.format_help();
+	std::printf("== schema\n%s", parser.memory().format().c_str());
+
+	const char* args[] = {"bench", "-I", "a", "b", "--option-1", "1", "--option-4999", "2", "cmd7", "--flag7", "a"};
+	argparse::CountingResource counter;
+	bool ok = parser.parse(sizeof(args)/sizeof(args[0]), args, &counter).ok();
+	std::printf("== parse (ok=%d, peak %lld bytes)\n%s", ok, counter.peak(), counter.stats().format().c_str());
+
+	std::string path = "/tmp/argparse-memory-footprint.txt";
+	{
+		std::ofstream out(path);
+		out << "-I\n";
+		for (int i=0; i<1000; i++) out << "dir" << i << "\n";
+	}
+	std::string file = "@" + path;
+	const char* fileargs[] = {"bench", file.c_str(), "--option-1", "1", "cmd0"};
+	counter.reset();
+	ok = parser.parse(5, fileargs, &counter).ok();
+	std::printf("== parse with a response file (ok=%d, peak %lld bytes)\n%s", ok, counter.peak(), counter.stats().format().c_str());
+	std::remove(path.c_str());
+	return 0;
+}
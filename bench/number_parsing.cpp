@@ -0,0 +1,53 @@
+// Compares argparse::parse_number() with the strtol/strtod validation it
+// replaced, which copied each token into a std::string and then built
+// another std::string from the end pointer to check for trailing characters.
+#include "argparse.h"
+#include <chrono>
+#include <cstdio>
+
+static bool old_int(std::string_view token, int& num){
+	std::string temp(token);
+	char *ending;
+	num = strtol(temp.c_str(), &ending, 10);
+	return std::string(ending) == "" && temp != "";
+}
+static bool old_double(std::string_view token, double& num){
+	std::string temp(token);
+	char *ending;
+	num = strtod(temp.c_str(), &ending);
+	return std::string(ending) == "" && temp != "";
+}
+
+template <typename T, typename F>
+static double time_ns(const std::vector<std::string>& tokens, F convert){
+	const int reps = 50;
+	volatile double sink = 0;
+	auto start = std::chrono::steady_clock::now();
+	for (int r=0; r<reps; r++){
+		for (const auto& token : tokens){
+			T num = 0;
+			if (convert(token, num)) sink = sink + num;
+		}
+	}
+	auto stop = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::nano>(stop-start).count()
+		/ reps / tokens.size();
+}
+
+int main(){
+	std::vector<std::string> ints, doubles;
+	for (int i=0; i<10000; i++){
+		ints.push_back(std::to_string(i*7919 - 5000000));
+		doubles.push_back(std::to_string(i*0.37 - 1000.0));
+	}
+	std::printf("%-10s %-14s %s\n", "type", "converter", "ns/token");
+	std::printf("%-10s %-14s %.1f\n", "int", "strtol",
+			time_ns<int>(ints, old_int));
+	std::printf("%-10s %-14s %.1f\n", "int", "parse_number",
+			time_ns<int>(ints, argparse::parse_number<int>));
+	std::printf("%-10s %-14s %.1f\n", "double", "strtod",
+			time_ns<double>(doubles, old_double));
+	std::printf("%-10s %-14s %.1f\n", "double", "parse_number",
+			time_ns<double>(doubles, argparse::parse_number<double>));
+	return 0;
+}
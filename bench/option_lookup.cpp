@@ -0,0 +1,58 @@
+// Measures the per-token cost of optional argument lookup as the number of
+// registered options grows. Each parse is timed at two line lengths (best of
+// several runs), and the cost per token is the slope between them, so that
+// the per-parse work (which grows with the option count) is left out. With
+// the option index the slope should stay flat; the last column is its
+// growth over the smallest schema.
+#include "argparse.h"
+#include <chrono>
+#include <cstdio>
+
+static const int REPS = 15;
+
+// Best time of one parse of line, in ns
+static double best(const argparse::ArgumentParser& parser, const std::vector<std::string>& line){
+	double result = 0;
+	for (int r=0; r<REPS; r++){
+		auto start = std::chrono::steady_clock::now();
+		bool ok = parser.parse(line).ok();
+		auto stop = std::chrono::steady_clock::now();
+		double ns = std::chrono::duration<double, std::nano>(stop-start).count();
+		if (!ok){
+			std::fprintf(stderr, "parse failed\n");
+			std::exit(2);
+		}
+		if (r == 0 || ns < result) result = ns;
+	}
+	return result;
+}
+
+int main(){
+	char prog[] = "bench";
+	char* argv[] = {prog, nullptr};
+	const int short_line = 1000, long_line = 11000;
+	std::printf("%-10s %-12s %-12s %-12s %s\n", "options", "ns/parse", "ns/parse", "ns/token", "growth");
+	std::printf("%-10s %-12d %-12d %-12s\n", "", short_line, long_line, "(slope)");
+	double base = 0;
+	for (int nopts : {10, 100, 1000, 5000, 20000}){
+		argparse::ArgumentParser parser(1, argv);
+		for (int i=0; i<nopts; i++)
+			parser.add_argument<int>("--opt" + std::to_string(i));
+		parser.freeze();
+
+		double times[2];
+		for (int k=0; k<2; k++){
+			int ntokens = (k == 0? short_line : long_line);
+			std::vector<std::string> line;
+			for (int i=0; i<ntokens/2; i++){
+				line.push_back("--opt" + std::to_string((i*7919) % nopts));
+				line.push_back(std::to_string(i));
+			}
+			times[k] = best(parser, line);
+		}
+		double slope = (times[1]-times[0]) / (long_line-short_line);
+		if (base == 0) base = slope;
+		std::printf("%-10d %-12.0f %-12.0f %-12.1f %.2fx\n", nopts, times[0], times[1], slope, slope/base);
+	}
+	return 0;
+}
@@ -0,0 +1,47 @@
+// Compares the first print_help() of a freshly built parser when the help is
+// rendered and when it is served from a precompiled HelpSnapshot (built here
+// from a rendered copy, as the help-snapshot makefile target would).
+#include "argparse.h"
+#include <chrono>
+#include <cstdio>
+
+static argparse::ArgumentParser build(int nopts){
+	char prog[] = "bench";
+	char* argv[] = {prog, nullptr};
+	argparse::ArgumentParser parser(1, argv);
+	for (int i=0; i<nopts; i++)
+		parser.add_argument("--option-" + std::to_string(i)).help("option number " + std::to_string(i));
+	parser.set_linecap(78);
+	return parser;
+}
+
+int main(){
+	std::printf("%-10s %-12s %s\n", "options", "render us", "snapshot us");
+	for (int nopts : {10, 100, 1000}){
+		const int reps = 20;
+		auto reference = build(nopts);
+		std::string usage = reference.format_usage(), help = reference.format_help();
+		argparse::HelpSnapshot snapshot[] = {{"bench", argparse::HelpFormatter::Default, 78,
+			usage.c_str(), help.c_str()}};
+
+		double rendered = 0, precompiled = 0;
+		for (int r=0; r<reps; r++){
+			std::ostringstream out;
+			auto parser = build(nopts);
+			parser.freeze();
+			auto start = std::chrono::steady_clock::now();
+			parser.print_help(out);
+			auto stop = std::chrono::steady_clock::now();
+			rendered += std::chrono::duration<double, std::micro>(stop-start).count();
+
+			auto snapped = build(nopts);
+			snapped.precompiled_help(snapshot).freeze();
+			start = std::chrono::steady_clock::now();
+			snapped.print_help(out);
+			stop = std::chrono::steady_clock::now();
+			precompiled += std::chrono::duration<double, std::micro>(stop-start).count();
+		}
+		std::printf("%-10d %-12.1f %.1f\n", nopts, rendered/reps, precompiled/reps);
+	}
+	return 0;
+}
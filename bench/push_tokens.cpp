@@ -0,0 +1,50 @@
+// Compares checking a command line after every token as it arrives, by
+// parsing the whole line again each time and by pushing the token to a
+// PushParser, as the command line grows.
+#include "argparse.h"
+#include <chrono>
+#include <cstdio>
+
+int main(){
+	char prog[] = "bench";
+	char* argv[] = {prog, nullptr};
+	argparse::ArgumentParser parser(1, argv);
+	parser.add_argument<int>("-n", "--num");
+	parser.add_argument<bool>("-v");
+	parser.add_argument("-I", "--include").nargs('+');
+	parser.add_argument("input");
+	parser.freeze();
+
+	std::printf("%-10s %-14s %s\n", "tokens", "reparse us", "push us");
+	for (int ntokens : {10, 100, 1000}){
+		std::vector<std::string> tokens{"-n", "5", "input.txt"};
+		for (int i=0; (int)tokens.size() < ntokens; i++){
+			tokens.push_back(i % 5? "-v" : "-I");
+			if (i % 5 == 0) tokens.push_back("dir" + std::to_string(i));
+		}
+		const int reps = std::max(1, 10000 / ntokens);
+
+		volatile int sink = 0;
+		auto start = std::chrono::steady_clock::now();
+		for (int r=0; r<reps; r++){
+			std::vector<std::string> line;
+			for (const auto& token : tokens){
+				line.push_back(token);
+				sink = sink + parser.parse(line).ok();
+			}
+		}
+		auto mid = std::chrono::steady_clock::now();
+		argparse::PushParser push(parser);
+		for (int r=0; r<reps; r++){
+			push.reset();
+			for (const auto& token : tokens)
+				sink = sink + (push.push(token) == argparse::PushParser::Status::Complete);
+			sink = sink + push.result().ok();
+		}
+		auto stop = std::chrono::steady_clock::now();
+		std::printf("%-10d %-14.1f %.1f\n", (int)tokens.size(),
+				std::chrono::duration<double, std::micro>(mid-start).count()/reps,
+				std::chrono::duration<double, std::micro>(stop-mid).count()/reps);
+	}
+	return 0;
+}
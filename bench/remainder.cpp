@@ -0,0 +1,40 @@
+// Measures parsing a launcher-style command line (a few options, a program
+// and a long trailing command line captured by REMAINDER) and getting the
+// trailing command line back as a span over argv, as the command grows.
+#include "argparse.h"
+#include <chrono>
+#include <cstdio>
+
+int main(){
+	char prog[] = "bench";
+	char* argv[] = {prog, nullptr};
+	argparse::ArgumentParser parser(1, argv);
+	parser.add_argument<bool>("-v");
+	parser.add_argument("--env").nargs('*');
+	parser.add_argument("exe");
+	parser.add_argument("args").nargs(argparse::REMAINDER);
+	parser.freeze();
+
+	std::printf("%-10s %-12s %s\n", "tokens", "parse ns", "span ns");
+	for (int ntokens : {10, 1000, 100000}){
+		std::vector<std::string> tokens{"bench", "-v", "--env", "A=1", "B=2", "/bin/child"};
+		for (int i=0; i<ntokens; i++)
+			tokens.push_back(i % 3? "arg" + std::to_string(i) : "--flag" + std::to_string(i));
+		std::vector<const char*> args;
+		for (const auto& token : tokens) args.push_back(token.c_str());
+		args.push_back(nullptr);
+		const int nargs = args.size()-1, reps = std::max(10, 100000 / ntokens);
+
+		volatile int sink = 0;
+		auto start = std::chrono::steady_clock::now();
+		for (int r=0; r<reps; r++) sink = sink + parser.parse(nargs, args.data()).ok();
+		auto mid = std::chrono::steady_clock::now();
+		auto result = parser.parse(nargs, args.data());
+		for (int r=0; r<reps; r++) sink = sink + result.span("args").size();
+		auto stop = std::chrono::steady_clock::now();
+		std::printf("%-10d %-12.1f %.1f\n", ntokens,
+				std::chrono::duration<double, std::nano>(mid-start).count()/reps,
+				std::chrono::duration<double, std::nano>(stop-mid).count()/reps);
+	}
+	return 0;
+}
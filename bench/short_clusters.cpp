@@ -0,0 +1,65 @@
+// Measures the per-character cost of decoding short option clusters such as
+// -vvvx as the number of registered options grows. The same number of
+// clusters is timed at two cluster lengths (best of several runs), and the
+// cost per character is the slope between them, so that the per-token and
+// per-parse work is left out. Clusters are decoded in one pass over the
+// token, so the slope should stay flat; the last column is its growth over
+// the smallest schema.
+#include "argparse.h"
+#include <chrono>
+#include <cstdio>
+
+static const int REPS = 15;
+
+// Best time of one parse of line, in ns
+static double best(const argparse::ArgumentParser& parser, const std::vector<std::string>& line){
+	double result = 0;
+	for (int r=0; r<REPS; r++){
+		auto start = std::chrono::steady_clock::now();
+		bool ok = parser.parse(line).ok();
+		auto stop = std::chrono::steady_clock::now();
+		double ns = std::chrono::duration<double, std::nano>(stop-start).count();
+		if (!ok){
+			std::fprintf(stderr, "parse failed\n");
+			std::exit(2);
+		}
+		if (r == 0 || ns < result) result = ns;
+	}
+	return result;
+}
+
+int main(){
+	char prog[] = "bench";
+	char* argv[] = {prog, nullptr};
+	const std::string letters = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+	const int ntokens = 2000, short_len = 4, long_len = 132;
+	std::printf("%-10s %-12s %-12s %-12s %s\n", "options", "ns/parse", "ns/parse", "ns/char", "growth");
+	std::printf("%-10s -%-11d -%-11d %-12s\n", "", short_len, long_len, "(slope)");
+	double base = 0;
+	for (int nopts : {10, 1000, 20000}){
+		argparse::ArgumentParser parser(1, argv);
+		parser.add_help(false);
+		for (char c : letters)
+			parser.add_argument<bool>(std::string("-") + c).count();
+		for (int i=letters.size(); i<nopts; i++)
+			parser.add_argument<int>("--opt" + std::to_string(i));
+		parser.freeze();
+
+		double times[2];
+		for (int k=0; k<2; k++){
+			int len = (k == 0? short_len : long_len);
+			std::vector<std::string> line;
+			for (int i=0; i<ntokens; i++){
+				std::string cluster = "-";
+				for (int j=0; j<len; j++)
+					cluster += letters[(i*31 + j*7) % letters.size()];
+				line.push_back(cluster);
+			}
+			times[k] = best(parser, line);
+		}
+		double slope = (times[1]-times[0]) / ntokens / (long_len-short_len);
+		if (base == 0) base = slope;
+		std::printf("%-10d %-12.0f %-12.0f %-12.1f %.2fx\n", nopts, times[0], times[1], slope, slope/base);
+	}
+	return 0;
+}
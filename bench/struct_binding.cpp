@@ -0,0 +1,51 @@
+// Compares filling a config struct from the ArgumentMap returned by
+// ParseResult::args() (casting each ArgumentValueList) with writing the
+// values straight into the struct through ParseResult::store().
+#include "argparse.h"
+#include <chrono>
+#include <cstdio>
+
+struct Config {
+	int num = 0;
+	double rate = 0;
+	bool verbose = false;
+	std::string name;
+	std::vector<std::string> files;
+};
+
+int main(){
+	char prog[] = "bench";
+	char* argv[] = {prog, nullptr};
+	argparse::ArgumentParser parser(1, argv);
+	ARGPARSE_FIELDS(parser, Config, num, rate, verbose, name, files)
+	parser.freeze();
+	auto result = parser.parse({"--num", "42", "--rate", "0.25", "--verbose",
+			"--name", "bench", "--files", "a.txt", "b.txt", "c.txt"});
+	const int reps = 100000;
+
+	volatile int sink = 0;
+	auto start = std::chrono::steady_clock::now();
+	for (int r=0; r<reps; r++){
+		Config config;
+		argparse::ArgumentMap args = result.args();
+		config.num = args["num"];
+		config.rate = args["rate"];
+		config.verbose = args["verbose"];
+		config.name = (std::string)args["name"];
+		config.files = args["files"].vec();
+		sink = sink + config.num + config.files.size();
+	}
+	auto mid = std::chrono::steady_clock::now();
+	for (int r=0; r<reps; r++){
+		Config config;
+		result.store(config);
+		sink = sink + config.num + config.files.size();
+	}
+	auto stop = std::chrono::steady_clock::now();
+	std::printf("%-12s %s\n", "fill", "ns/struct");
+	std::printf("%-12s %.1f\n", "ArgumentMap",
+			std::chrono::duration<double, std::nano>(mid-start).count()/reps);
+	std::printf("%-12s %.1f\n", "store()",
+			std::chrono::duration<double, std::nano>(stop-mid).count()/reps);
+	return 0;
+}
@@ -0,0 +1,192 @@
+// Benchmark suite over synthetic schemas, for catching regressions. Prints one
+// JSON object per measurement:
+// 	{"bench": name, "size": n, "reps": r, "ns_per_op": t, "items_per_sec": x}
+// where size is the schema or input size and items are the options,
+// tokens or values handled per operation. Each measurement is the fastest
+// of several batches. An argument limits the run to the benches whose name
+// begins with it.
+#include "argparse.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+static const char* filter = "";
+static char prog[] = "suite";
+static char* argv0[] = {prog, nullptr};
+
+// Times fn (reps calls per batch, best of batches) and prints the result
+template <typename F>
+static void measure(const char* name, long size, long items, int reps, F fn){
+	if (std::strncmp(name, filter, std::strlen(filter)) != 0) return;
+	double best = 0;
+	for (int batch=0; batch<5; batch++){
+		auto start = std::chrono::steady_clock::now();
+		for (int r=0; r<reps; r++) fn();
+		auto stop = std::chrono::steady_clock::now();
+		double ns = std::chrono::duration<double, std::nano>(stop-start).count()/reps;
+		if (batch == 0 || ns < best) best = ns;
+	}
+	std::printf("{\"bench\": \"%s\", \"size\": %ld, \"reps\": %d, \"ns_per_op\": %.1f, "
+			"\"items_per_sec\": %.0f}\n", name, size, reps, best, items*1e9/best);
+	std::fflush(stdout);
+}
+
+static void options(argparse::ArgumentParser& parser, int nopts){
+	for (int i=0; i<nopts; i++)
+		parser.add_argument<int>("--option-" + std::to_string(i)).help("option number " + std::to_string(i));
+}
+
+int main(int argc, char** argv){
+	if (argc > 1) filter = argv[1];
+	volatile long sink = 0;
+
+	// Registration (add_argument() and check_conflict(), or a table given to
+	// add_arguments()) and freezing
+	for (int nopts : {10, 100, 1000, 10000}){
+		const int reps = std::max(1, 10000 / nopts);
+		measure("register", nopts, nopts, reps, [&]{
+			argparse::ArgumentParser parser(1, argv0);
+			options(parser, nopts);
+			sink = sink + parser.frozen();
+		});
+		measure("register+freeze", nopts, nopts, reps, [&]{
+			argparse::ArgumentParser parser(1, argv0);
+			options(parser, nopts);
+			sink = sink + parser.freeze().frozen();
+		});
+		std::vector<argparse::ArgumentSpec> specs(nopts);
+		for (int i=0; i<nopts; i++)
+			specs[i] = {"--option-" + std::to_string(i), "int", "option number " + std::to_string(i)};
+		measure("add_arguments+freeze", nopts, nopts, reps, [&]{
+			argparse::ArgumentParser parser(1, argv0);
+			sink = sink + parser.add_arguments(specs).freeze().frozen();
+		});
+	}
+
+	// Parsing a short command line against schemas of each size, through
+	// parse() and through parse_args() (which also builds the ArgumentMap)
+	for (int nopts : {10, 100, 1000, 10000}){
+		argparse::ArgumentParser parser(1, argv0);
+		options(parser, nopts);
+		parser.add_argument("input");
+		parser.freeze();
+		std::vector<std::string> line{"--option-0", "1", "--option-" + std::to_string(nopts/2), "2",
+			"--option-" + std::to_string(nopts-1), "3", "input.txt"};
+		std::vector<const char*> args{prog};
+		for (const auto& token : line) args.push_back(token.c_str());
+		const int reps = std::max(10, 100000 / nopts);
+		measure("parse", nopts, line.size(), reps, [&]{
+			sink = sink + parser.parse(args.size(), args.data()).ok();
+		});
+		measure("parse_args", nopts, line.size(), reps, [&]{
+			sink = sink + parser.parse_args(line).size();
+		});
+	}
+
+	// Help: rendering (after the linecap changes, so the parser is frozen
+	// again) and the cached copy
+	for (int nopts : {10, 100, 1000, 10000}){
+		argparse::ArgumentParser parser(1, argv0);
+		options(parser, nopts);
+		parser.freeze();
+		const int reps = std::max(1, 1000 / nopts);
+		int linecap = 78;
+		measure("format_help", nopts, nopts, reps, [&]{
+			parser.set_linecap(linecap ^= 1);
+			sink = sink + parser.format_help().size();
+		});
+		measure("format_help_cached", nopts, nopts, reps*100, [&]{
+			sink = sink + parser.format_help().size();
+		});
+	}
+
+	// Subcommand trees: every level has 10 subcommands, and the command
+	// line descends through the first of each
+	for (int depth : {1, 4, 16}){
+		argparse::ArgumentParser parser(1, argv0);
+		argparse::ArgumentParser* level = &parser;
+		std::vector<std::string> line;
+		for (int d=0; d<depth; d++){
+			level->add_argument<bool>("--flag" + std::to_string(d));
+			auto& subparsers = level->add_subparsers().dest("cmd" + std::to_string(d));
+			for (int i=9; i>0; i--) subparsers.add_parser("cmd" + std::to_string(i));
+			level = &subparsers.add_parser("cmd0");
+			line.push_back("--flag" + std::to_string(d));
+			line.push_back("cmd0");
+		}
+		parser.freeze();
+		measure("subparsers", depth, line.size(), std::max(10, 10000 / depth), [&]{
+			sink = sink + parser.parse(line).ok();
+		});
+	}
+
+	// Startup of a CLI with many subcommands (building, freezing and parsing
+	// one command), with the subcommands built eagerly and lazily
+	for (int ncmds : {10, 100, 1000}){
+		std::vector<std::string> line{"cmd" + std::to_string(ncmds/2), "--option-1", "1"};
+		const int reps = std::max(1, 1000 / ncmds);
+		measure("subcommands_eager", ncmds, ncmds, reps, [&]{
+			argparse::ArgumentParser parser(1, argv0);
+			auto& subparsers = parser.add_subparsers().dest("cmd");
+			for (int i=0; i<ncmds; i++)
+				options(subparsers.add_parser("cmd" + std::to_string(i)).help("command"), 20);
+			sink = sink + parser.freeze().parse(line).ok();
+		});
+		measure("subcommands_lazy", ncmds, ncmds, reps, [&]{
+			argparse::ArgumentParser parser(1, argv0);
+			auto& subparsers = parser.add_subparsers().dest("cmd");
+			for (int i=0; i<ncmds; i++)
+				subparsers.add_parser("cmd" + std::to_string(i), "command",
+					[](argparse::ArgumentParser& sub){options(sub, 20);});
+			sink = sink + parser.freeze().parse(line).ok();
+		});
+	}
+
+	// nargs('+') lists
+	for (int nvals : {1000, 1000000}){
+		argparse::ArgumentParser parser(1, argv0);
+		parser.add_argument("--strings").nargs('+');
+		parser.add_argument<int>("--ints").nargs('+');
+		parser.freeze();
+		std::vector<std::string> values;
+		for (int i=0; i<nvals; i++) values.push_back(std::to_string(i));
+		for (const char* name : {"--strings", "--ints"}){
+			std::vector<const char*> args{prog, name};
+			for (const auto& value : values) args.push_back(value.c_str());
+			const char* bench = (name[2] == 's'? "nargs+_strings" : "nargs+_ints");
+			measure(bench, nvals, nvals, std::max(1, 100000 / nvals), [&]{
+				sink = sink + parser.parse(args.size(), args.data()).ok();
+			});
+		}
+	}
+
+	// Response files read with fromfile_prefix_chars()
+	for (int nlines : {1000, 100000}){
+		argparse::ArgumentParser parser(1, argv0);
+		parser.fromfile_prefix_chars("@");
+		parser.add_argument<bool>("-v").count();
+		parser.add_argument("files").nargs('*');
+		parser.freeze();
+		std::string path = "/tmp/argparse-suite-" + std::to_string(nlines) + ".txt";
+		{
+			std::ofstream out(path);
+			for (int i=0; i<nlines; i++)
+				out << (i % 2? "file" + std::to_string(i) + ".txt" : std::string("-v")) << "\n";
+		}
+		std::vector<std::string> line{"@" + path};
+		measure("response_file", nlines, nlines, std::max(1, 100000 / nlines), [&]{
+			sink = sink + parser.parse(line).ok();
+		});
+		std::remove(path.c_str());
+	}
+
+	// ArgumentValue conversions
+	{
+		argparse::ArgumentValue num("12345"), real("3.25"), flag("True");
+		const int reps = 1000000;
+		measure("ArgumentValue_int", 1, 1, reps, [&]{sink = sink + (int)num;});
+		measure("ArgumentValue_double", 1, 1, reps, [&]{sink = sink + (long)(double)real;});
+		measure("ArgumentValue_bool", 1, 1, reps, [&]{sink = sink + (bool)flag;});
+	}
+	return 0;
+}
@@ -0,0 +1,35 @@
+// Measures the cost of reading a parsed value in a hot loop, either by
+// casting the string value (which reparses it every time) or with
+// ParseResult::get<T>() (which returns the value stored in native form).
+#include "argparse.h"
+#include <chrono>
+#include <cstdio>
+
+int main(){
+	char prog[] = "bench";
+	char* argv[] = {prog, nullptr};
+	argparse::ArgumentParser parser(1, argv);
+	parser.add_argument<int>("--num");
+	parser.add_argument<double>("--rate");
+	parser.add_argument<bool>("-v").count();
+	parser.freeze();
+	auto result = parser.parse({"--num", "123456", "--rate", "0.125", "-vvv"});
+	const int reads = 1000000;
+
+	std::printf("%-12s %s\n", "read", "ns/read");
+	volatile double sink = 0;
+	auto start = std::chrono::steady_clock::now();
+	argparse::ArgumentMap args = result.args();
+	for (int i=0; i<reads; i++)
+		sink = sink + (int)args["num"] + (double)args["rate"] + (int)args["v"];
+	auto mid = std::chrono::steady_clock::now();
+	for (int i=0; i<reads; i++)
+		sink = sink + result.get<int>("num") + result.get<double>("rate")
+			+ result.get<int>("v");
+	auto stop = std::chrono::steady_clock::now();
+	std::printf("%-12s %.1f\n", "cast",
+			std::chrono::duration<double, std::nano>(mid-start).count()/reads/3);
+	std::printf("%-12s %.1f\n", "get<T>",
+			std::chrono::duration<double, std::nano>(stop-mid).count()/reads/3);
+	return 0;
+}
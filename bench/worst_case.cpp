@@ -0,0 +1,289 @@
+// Worst-case latency harness: parses adversarial command lines (and schemas
+// shaped to stress one path) and registers large schemas at growing sizes,
+// and prints one JSON object per measurement:
+// 	{"case": name, "size": n, "ns_per_op": t}
+// followed by the growth of each case, the slope of log(time) over log(size):
+// 	{"case": name, "exponent": e, "max": m, "ok": true}
+// Exits with 1 if any case grows faster than its maximum, MAX_EXPONENT
+// (linear, with room for noise and cache effects) unless the case is known
+// to grow faster. An argument limits the run to the cases whose name begins
+// with it.
+#include "argparse.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+static const double MAX_EXPONENT = 1.15;
+// Registration is O(n log n): freeze() sorts the long names to build the
+// prefix trie. Past about 10k options the schema (about half a KB for each
+// Argument) also no longer fits in cache
+static const double REGISTER_EXPONENT = 1.35;
+static const int BATCHES = 9;
+static char prog[] = "worst";
+static char* argv0[] = {prog, nullptr};
+static std::vector<std::string> files;
+
+// Builds the schema and the command line of a case for the given size, and
+// returns the operation to time (the parse, or the registration)
+using Setup = std::function<std::function<bool()>(int)>;
+
+struct Case {
+	const char* name;
+	int base;
+	Setup setup;
+	double max_exponent = MAX_EXPONENT;
+};
+
+// Best time of an operation over BATCHES batches of at least a few ms
+static double measure(const std::function<bool()>& fn){
+	int reps = 1;
+	double best = 0;
+	for (int batch=0; batch<BATCHES; batch++){
+		while (true){
+			auto start = std::chrono::steady_clock::now();
+			for (int r=0; r<reps; r++) fn();
+			auto stop = std::chrono::steady_clock::now();
+			double ns = std::chrono::duration<double, std::nano>(stop-start).count();
+			if (ns < 5e6 && reps < (1 << 20)){
+				reps *= 2;
+				continue;
+			}
+			if (batch == 0 || ns/reps < best) best = ns/reps;
+			break;
+		}
+	}
+	return best;
+}
+
+// Parses line (which must be parsed successfully, so that every case times
+// the whole parse rather than an early error)
+static std::function<bool()> parsing(std::shared_ptr<argparse::ArgumentParser> parser,
+		std::vector<std::string> line, bool ok = true){
+	parser->freeze();
+	if (parser->parse(line).ok() != ok){
+		std::fprintf(stderr, "unexpected parse result: %s\n", parser->parse(line).message().c_str());
+		std::exit(2);
+	}
+	return [=]{return parser->parse(line).ok();};
+}
+
+static std::shared_ptr<argparse::ArgumentParser> make_parser(){
+	return std::make_shared<argparse::ArgumentParser>(1, argv0);
+}
+
+static std::vector<Case> cases(){
+	std::vector<Case> result;
+	// -vvvv... as a single cluster of count flags
+	result.push_back({"cluster", 4096, [](int n){
+		auto parser = make_parser();
+		parser->add_argument<bool>("-v").count();
+		return parsing(parser, {"-" + std::string(n, 'v')});
+	}});
+	// Clusters of flags ending in an optarg that takes the rest of the token
+	// (repeated options keep the last value)
+	result.push_back({"clusters_attached", 1024, [](int n){
+		auto parser = make_parser();
+		parser->add_argument<bool>("-a");
+		parser->add_argument<bool>("-b");
+		parser->add_argument("-o");
+		std::vector<std::string> line(n, "-abo" + std::string(16, 'x'));
+		return parsing(parser, line);
+	}});
+	// --define=key=value tokens, in full and abbreviated
+	result.push_back({"equals", 1024, [](int n){
+		auto parser = make_parser();
+		parser->add_argument("--define");
+		parser->add_argument("--defer");
+		std::vector<std::string> line;
+		for (int i=0; i<n; i++) line.push_back("--define=key" + std::to_string(i) + "=value");
+		return parsing(parser, line);
+	}});
+	result.push_back({"equals_abbrev", 1024, [](int n){
+		auto parser = make_parser();
+		parser->add_argument("--define");
+		parser->add_argument("--verbose");
+		std::vector<std::string> line;
+		for (int i=0; i<n; i++) line.push_back("--def=key" + std::to_string(i) + "=value");
+		return parsing(parser, line);
+	}});
+	// Unknown options, all reported in the error
+	result.push_back({"unrecognized", 1024, [](int n){
+		auto parser = make_parser();
+		parser->add_argument("--define");
+		std::vector<std::string> line;
+		for (int i=0; i<n; i++) line.push_back("--bogus" + std::to_string(i) + "=x");
+		return parsing(parser, line, false);
+	}});
+	// A long list of values for one option
+	result.push_back({"nargs+", 4096, [](int n){
+		auto parser = make_parser();
+		parser->add_argument<int>("--ints").nargs('+');
+		std::vector<std::string> line{"--ints"};
+		for (int i=0; i<n; i++) line.push_back(std::to_string(i));
+		return parsing(parser, line);
+	}});
+	// Positional values collected by a '*' posarg between required ones,
+	// after -- and interleaved with options
+	result.push_back({"posargs_collection", 1024, [](int n){
+		auto parser = make_parser();
+		parser->add_argument("first");
+		parser->add_argument("files").nargs('*');
+		parser->add_argument("last");
+		std::vector<std::string> line;
+		for (int i=0; i<n; i++) line.push_back("file" + std::to_string(i));
+		return parsing(parser, line);
+	}});
+	result.push_back({"posargs_separator", 1024, [](int n){
+		auto parser = make_parser();
+		parser->add_argument<bool>("-v");
+		parser->add_argument("files").nargs('+');
+		std::vector<std::string> line{"-v", "--"};
+		for (int i=0; i<n; i++) line.push_back("-file" + std::to_string(i));
+		return parsing(parser, line);
+	}});
+	result.push_back({"posargs_interleaved", 1024, [](int n){
+		auto parser = make_parser();
+		parser->add_argument<bool>("-v").count();
+		parser->add_argument("files").nargs('*');
+		std::vector<std::string> line;
+		for (int i=0; i<n; i++){
+			line.push_back("file" + std::to_string(i));
+			line.push_back("-v");
+		}
+		return parsing(parser, line);
+	}});
+	// Thousands of optional posargs, half of them filled (so that the
+	// assignment moves past each unfilled one)
+	result.push_back({"optional_posargs", 256, [](int n){
+		auto parser = make_parser();
+		parser->add_argument("head").nargs('+');
+		for (int i=0; i<n; i++) parser->add_argument("opt" + std::to_string(i)).nargs('?');
+		parser->add_argument("tail");
+		std::vector<std::string> line;
+		for (int i=0; i<n/2+2; i++) line.push_back("value" + std::to_string(i));
+		return parsing(parser, line);
+	}});
+	// Values (and options) passed down a chain of subcommands to the last
+	// one (each level is handed the tokens after its command)
+	result.push_back({"subparsers_deep", 256, [](int n){
+		auto parser = make_parser();
+		argparse::ArgumentParser* level = parser.get();
+		std::vector<std::string> line;
+		for (int d=0; d<16; d++){
+			level->add_argument<bool>("--flag" + std::to_string(d));
+			level = &level->add_subparsers().dest("cmd" + std::to_string(d)).add_parser("next");
+			line.push_back("next");
+		}
+		level->add_argument<bool>("-v").count();
+		level->add_argument("files").nargs('*');
+		for (int i=0; i<n; i++){
+			line.push_back("file" + std::to_string(i));
+			line.push_back("-v");
+		}
+		return parsing(parser, line);
+	}});
+	// Subcommands with many siblings
+	result.push_back({"subparsers_wide", 64, [](int n){
+		auto parser = make_parser();
+		auto& subparsers = parser->add_subparsers().dest("cmd");
+		for (int i=0; i<n; i++) subparsers.add_parser("cmd" + std::to_string(i));
+		std::vector<std::string> line{"cmd" + std::to_string(n-1)};
+		return parsing(parser, line);
+	}});
+	// Abbreviated commands at each level of a chain, among many aliased
+	// siblings
+	result.push_back({"subparsers_abbrev", 64, [](int n){
+		auto parser = make_parser();
+		argparse::ArgumentParser* level = parser.get();
+		std::vector<std::string> line;
+		for (int d=0; d<8; d++){
+			auto& subparsers = level->add_subparsers().dest("cmd" + std::to_string(d));
+			for (int i=1; i<n; i++)
+				subparsers.add_parser("command" + std::to_string(i), {"c" + std::to_string(i)});
+			level = &subparsers.add_parser("next", {"n"});
+			line.push_back("nex");
+		}
+		return parsing(parser, line);
+	}});
+	// An option with many choices, given each of them
+	result.push_back({"choices", 1024, [](int n){
+		auto parser = make_parser();
+		std::string choices;
+		for (int i=0; i<n; i++) choices += (i? "," : "") + ("c" + std::to_string(i));
+		parser->add_argument("--pick").choices(choices);
+		std::vector<std::string> line;
+		for (int i=0; i<n; i++) line.push_back("--pick=c" + std::to_string(n-1-i));
+		return parsing(parser, line);
+	}});
+	// A response file of flags and positional values
+	result.push_back({"response_file", 1024, [](int n){
+		auto parser = make_parser();
+		parser->fromfile_prefix_chars("@");
+		parser->add_argument<bool>("-v").count();
+		parser->add_argument("files").nargs('*');
+		std::string path = "/tmp/argparse-worst-" + std::to_string(n) + ".txt";
+		files.push_back(path);
+		{
+			std::ofstream out(path);
+			for (int i=0; i<n; i++)
+				out << (i % 2? "file" + std::to_string(i) + ".txt" : std::string("-v")) << "\n";
+		}
+		return parsing(parser, {"@" + path});
+	}});
+	// Registering options one at a time, in a table, and with each one
+	// overriding part of an earlier one (conflict_handler("resolve"))
+	result.push_back({"register", 1024, [](int n){
+		return std::function<bool()>([n]{
+			argparse::ArgumentParser parser(1, argv0);
+			for (int i=0; i<n; i++) parser.add_argument("--option-" + std::to_string(i));
+			return parser.freeze().frozen();
+		});
+	}, REGISTER_EXPONENT});
+	result.push_back({"register_table", 1024, [](int n){
+		std::vector<argparse::ArgumentSpec> specs(n);
+		for (int i=0; i<n; i++) specs[i].names = "--option-" + std::to_string(i);
+		return std::function<bool()>([specs]{
+			argparse::ArgumentParser parser(1, argv0);
+			return parser.add_arguments(specs).freeze().frozen();
+		});
+	}, REGISTER_EXPONENT});
+	result.push_back({"register_resolve", 1024, [](int n){
+		return std::function<bool()>([n]{
+			argparse::ArgumentParser parser(1, argv0);
+			parser.conflict_handler("resolve");
+			for (int i=0; i<n; i++)
+				parser.add_argument("--option-" + std::to_string(i/2)).help(std::to_string(i));
+			return parser.freeze().frozen();
+		});
+	}, REGISTER_EXPONENT});
+	return result;
+}
+
+int main(int argc, char** argv){
+	const char* filter = (argc > 1? argv[1] : "");
+	bool failed = false;
+	for (const auto& test : cases()){
+		if (std::strncmp(test.name, filter, std::strlen(filter)) != 0) continue;
+		// Least-squares slope of log(time) over log(size), for sizes
+		// base to 32*base
+		double sx = 0, sy = 0, sxx = 0, sxy = 0;
+		const int npoints = 6;
+		for (int k=0; k<npoints; k++){
+			int size = test.base << k;
+			double ns = measure(test.setup(size));
+			std::printf("{\"case\": \"%s\", \"size\": %d, \"ns_per_op\": %.1f}\n", test.name, size, ns);
+			std::fflush(stdout);
+			double x = std::log(size), y = std::log(ns);
+			sx += x, sy += y, sxx += x*x, sxy += x*y;
+		}
+		double exponent = (npoints*sxy - sx*sy) / (npoints*sxx - sx*sx);
+		bool ok = exponent <= test.max_exponent;
+		std::printf("{\"case\": \"%s\", \"exponent\": %.2f, \"max\": %.2f, \"ok\": %s}\n", 
+				test.name, exponent, test.max_exponent, ok? "true" : "false");
+		std::fflush(stdout);
+		failed = failed || !ok;
+	}
+	for (const auto& path : files) std::remove(path.c_str());
+	return failed? 1 : 0;
+}
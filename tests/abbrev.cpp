@@ -0,0 +1,67 @@
+// Parses abbreviated long options and checks that a unique prefix selects its
+// option (also in the --name=value form), that an ambiguous one is rejected
+// with the candidates in the message, that an exact name wins over the longer
+// names it is a prefix of, and that allow_abbrev(false) only accepts full
+// names.
+#include "argparse.h"
+#include <cstdio>
+
+static char prog[] = "test";
+static char* argv0[] = {prog, nullptr};
+static int failures = 0;
+
+static void check(bool cond, const std::string& what){
+	if (cond) return;
+	std::fprintf(stderr, "FAILED: %s\n", what.c_str());
+	failures++;
+}
+
+// Parses line and checks that it stores value into dest
+static void expect(const argparse::ArgumentParser& parser, const std::vector<std::string>& line,
+		const std::string& dest, const std::string& value){
+	std::string given = "";
+	for (const auto& token : line) given += (given == ""? "" : " ") + token;
+	auto result = parser.parse(line);
+	check(result.ok(), "\"" + given + "\" is rejected: " + result.message());
+	if (!result.ok()) return;
+	std::string stored = result.get<std::string>(dest);
+	check(stored == value, "\"" + given + "\" stores \"" + stored + "\" in " + dest
+			+ ", not \"" + value + "\"");
+}
+
+int main(){
+	{
+		argparse::ArgumentParser parser(1, argv0);
+		parser.add_argument("--verbose");
+		parser.add_argument("--prefix");
+		parser.add_argument("--col");
+		parser.add_argument("--color");
+		parser.add_argument("--column");
+		parser.freeze();
+		expect(parser, {"--verb", "2"}, "verbose", "2");
+		expect(parser, {"--pre=/usr"}, "prefix", "/usr");
+		expect(parser, {"--col", "x"}, "col", "x");
+		expect(parser, {"--colu", "y"}, "column", "y");
+		expect(parser, {"--colo=z"}, "color", "z");
+
+		auto result = parser.parse({"--co", "x"});
+		std::string message = "ambiguous option: --co could match --col, --color, --column";
+		check(!result.ok(), "\"--co x\" is accepted");
+		check(result.message() == message, "\"--co x\" reports \"" + result.message() + "\"");
+		check(!parser.parse({"-v", "x"}).ok(), "\"-v x\" is taken for --verbose");
+	}
+	{
+		argparse::ArgumentParser parser(1, argv0);
+		parser.add_argument("--verbose");
+		parser.add_argument("--prefix");
+		parser.allow_abbrev(false);
+		parser.freeze();
+		expect(parser, {"--verbose", "2"}, "verbose", "2");
+		expect(parser, {"--prefix=/usr"}, "prefix", "/usr");
+		check(!parser.parse({"--verb", "2"}).ok(), "\"--verb 2\" is accepted without abbreviations");
+		check(!parser.parse({"--pre=/usr"}).ok(), "\"--pre=/usr\" is accepted without abbreviations");
+	}
+	if (failures) std::printf("FAILED (%d)\n", failures);
+	else std::printf("OK\n");
+	return failures? 1 : 0;
+}
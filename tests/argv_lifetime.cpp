@@ -0,0 +1,26 @@
+// Builds a parser from an argv that is overwritten and freed right after,
+// and checks that parse_args() still sees the original arguments (the
+// parser keeps its own copies of them).
+#include "argparse.h"
+#include <cstdio>
+#include <cstring>
+
+int main(){
+	std::vector<std::string> line{"/usr/bin/prog", "--name", "value", "input.txt"};
+	std::vector<char*> argv;
+	for (const auto& token : line) argv.push_back(strdup(token.c_str()));
+	argv.push_back(nullptr);
+	argparse::ArgumentParser parser(line.size(), argv.data());
+	for (int i=0; i<line.size(); i++){
+		std::memset(argv[i], 'x', line[i].size());
+		std::free(argv[i]);
+	}
+	
+	parser.add_argument("--name");
+	parser.add_argument("input");
+	auto args = parser.parse_args();
+	bool ok = args["name"].size() == 1 && args["name"][0] == "value" 
+		&& args["input"].size() == 1 && args["input"][0] == "input.txt";
+	std::printf(ok? "OK\n" : "FAILED\n");
+	return ok? 0 : 1;
+}
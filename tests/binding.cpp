@@ -0,0 +1,100 @@
+// Binds args to variables and struct members and checks that store() writes
+// every supported type (including std::vector), that store(target) writes
+// the members of target, that args which were not given and have no default
+// leave them alone, and that add_field()/ARGPARSE_FIELDS name the optarg of a
+// member such as dry_run --dry-run.
+#include "argparse.h"
+#include <cstdio>
+
+static char prog[] = "test";
+static char* argv0[] = {prog, nullptr};
+static int failures = 0;
+
+static void check(bool cond, const std::string& what){
+	if (cond) return;
+	std::fprintf(stderr, "FAILED: %s\n", what.c_str());
+	failures++;
+}
+
+struct Config {
+	int jobs = 1;
+	bool dry_run = false;
+	double ratio = 0.5;
+	float scale = 2;
+	std::string name = "none";
+	std::vector<std::string> files{"default.txt"};
+	std::vector<int> ids{7};
+	int level = 0;
+};
+
+int main(){
+	{
+		int i = -1;
+		float f = -1;
+		double d = -1;
+		bool b = false;
+		std::string s = "unset";
+		std::vector<int> v{-1};
+		std::vector<std::string> vs{"unset"};
+		argparse::ArgumentParser parser(1, argv0);
+		parser.add_argument<int>("--i").bind(i);
+		parser.add_argument<float>("--f").bind(f);
+		parser.add_argument<double>("--d").bind(d);
+		parser.add_argument<bool>("--b").bind(b);
+		parser.add_argument("--s").bind(s);
+		parser.add_argument<int>("--v").nargs('+').bind(v);
+		parser.add_argument("--vs").nargs('+').bind(vs);
+		parser.freeze();
+
+		auto result = parser.parse({"--i", "3"});
+		check(result.ok(), "\"--i 3\" is rejected: " + result.message());
+		result.store();
+		check(i == 3, "i is " + std::to_string(i));
+		check(f == -1 && d == -1 && s == "unset" && v == std::vector<int>{-1}
+				&& vs == std::vector<std::string>{"unset"}, "args that were not given are stored");
+
+		result = parser.parse({"--f", "1.5", "--d", "0.25", "--b", "--s", "text",
+				"--v", "4", "5", "--vs", "a", "b", "c"});
+		check(result.ok(), "all the args are rejected: " + result.message());
+		result.store();
+		check(i == 3, "i is overwritten with " + std::to_string(i));
+		check(f == 1.5f, "f is " + std::to_string(f));
+		check(d == 0.25, "d is " + std::to_string(d));
+		check(b, "b is false");
+		check(s == "text", "s is " + s);
+		check(v == std::vector<int>{4, 5}, "v is not {4, 5}");
+		check(vs == std::vector<std::string>{"a", "b", "c"}, "vs is not {a, b, c}");
+	}
+	{
+		argparse::ArgumentParser parser(1, argv0);
+		ARGPARSE_FIELDS(parser, Config, jobs, dry_run, ratio, scale, name, files, ids);
+		parser.add_field(&Config::level, "-l");
+		parser.freeze();
+
+		Config config;
+		auto result = parser.parse({"--jobs", "4"});
+		check(result.ok(), "\"--jobs 4\" is rejected: " + result.message());
+		result.store(config);
+		check(config.jobs == 4, "jobs is " + std::to_string(config.jobs));
+		check(config.ratio == 0.5 && config.scale == 2 && config.name == "none"
+				&& config.files == std::vector<std::string>{"default.txt"}
+				&& config.ids == std::vector<int>{7} && config.level == 0,
+				"members whose args were not given are stored");
+
+		result = parser.parse({"--dry-run", "--ratio", "0.25", "--scale", "1.5", "--name", "n",
+				"--files", "a", "b", "--ids", "1", "2", "3", "-l", "9"});
+		check(result.ok(), "all the fields are rejected: " + result.message());
+		result.store(config);
+		check(config.jobs == 4, "jobs is overwritten with " + std::to_string(config.jobs));
+		check(config.dry_run, "dry_run is false");
+		check(config.ratio == 0.25 && config.scale == 1.5f, "ratio/scale are not 0.25/1.5");
+		check(config.name == "n", "name is " + config.name);
+		check(config.files == std::vector<std::string>{"a", "b"}, "files is not {a, b}");
+		check(config.ids == std::vector<int>{1, 2, 3}, "ids is not {1, 2, 3}");
+		check(config.level == 9, "level is " + std::to_string(config.level));
+		check(!parser.parse({"--dry_run"}).ok(), "--dry_run is accepted for dry_run");
+	}
+	if (failures) std::printf("FAILED (%d)\n", failures);
+	else std::printf("OK\n");
+	return failures? 1 : 0;
+}
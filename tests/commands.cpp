@@ -0,0 +1,75 @@
+// Parses sub-commands given by alias and by prefix, and checks that the
+// command's own name is stored in the destination, that a prefix of several
+// commands is rejected with the candidates in the message, and that
+// allow_abbrev(false) only accepts full names and aliases.
+#include "argparse.h"
+#include <cstdio>
+
+static char prog[] = "test";
+static char* argv0[] = {prog, nullptr};
+static int failures = 0;
+
+static void check(bool cond, const std::string& what){
+	if (cond) return;
+	std::fprintf(stderr, "FAILED: %s\n", what.c_str());
+	failures++;
+}
+
+// Parses line and checks that it selects command (or fails if it is empty)
+static void expect(const argparse::ArgumentParser& parser, const std::vector<std::string>& line,
+		const std::string& command){
+	std::string given = "";
+	for (const auto& token : line) given += (given == ""? "" : " ") + token;
+	auto result = parser.parse(line);
+	if (command == ""){
+		check(!result.ok(), "\"" + given + "\" is accepted");
+		return;
+	}
+	check(result.ok(), "\"" + given + "\" is rejected: " + result.message());
+	if (!result.ok()) return;
+	std::string stored = result.get<std::string>("command");
+	check(stored == command, "\"" + given + "\" stores " + stored + ", not " + command);
+}
+
+// Builds a parser with the commands checkout (co), commit (ci) and status
+static void build(argparse::ArgumentParser& parser){
+	parser.add_help(false);
+	auto& subparsers = parser.add_subparsers().dest("command");
+	subparsers.add_parser("checkout", {"co"}).add_argument("branch");
+	subparsers.add_parser("commit", {"ci"}).add_argument<bool>("-a");
+	subparsers.add_parser("status");
+	parser.freeze();
+}
+
+int main(){
+	{
+		argparse::ArgumentParser parser(1, argv0);
+		build(parser);
+		expect(parser, {"co", "main"}, "checkout");
+		expect(parser, {"ci", "-a"}, "commit");
+		expect(parser, {"che", "main"}, "checkout");
+		expect(parser, {"com"}, "commit");
+		expect(parser, {"stat"}, "status");
+		check(parser.parse({"co", "main"}).get<std::string>("branch") == "main",
+				"\"co main\" does not reach checkout's parser");
+
+		auto result = parser.parse({"c"});
+		std::string message = "ambiguous command: c could match checkout, commit";
+		check(!result.ok(), "\"c\" is accepted");
+		check(result.message() == message, "\"c\" reports \"" + result.message() + "\"");
+	}
+	{
+		argparse::ArgumentParser parser(1, argv0);
+		parser.allow_abbrev(false);
+		build(parser);
+		expect(parser, {"checkout", "main"}, "checkout");
+		expect(parser, {"co", "main"}, "checkout");
+		expect(parser, {"ci"}, "commit");
+		expect(parser, {"che", "main"}, "");
+		expect(parser, {"com"}, "");
+		expect(parser, {"stat"}, "");
+	}
+	if (failures) std::printf("FAILED (%d)\n", failures);
+	else std::printf("OK\n");
+	return failures? 1 : 0;
+}
@@ -0,0 +1,62 @@
+// Parses from several threads at once against lazy subcommands that are not
+// built yet, so that the first parses build them (and add their
+// destinations) while the others read the shared destinations. Run under
+// -fsanitize=thread (the default TEST_FLAGS) to catch data races.
+#include "argparse.h"
+#include <cstdio>
+
+static char prog[] = "test";
+static char* argv0[] = {prog, nullptr};
+static std::atomic<int> failures(0);
+
+static void check(bool cond, const std::string& what){
+	if (cond) return;
+	std::fprintf(stderr, "FAILED: %s\n", what.c_str());
+	failures++;
+}
+
+int main(){
+	const int ncmds = 8, nthreads = 8, reps = 50;
+	for (int round=0; round<20; round++){
+		argparse::ArgumentParser parser(1, argv0);
+		parser.add_argument<bool>("-v");
+		auto& subparsers = parser.add_subparsers().dest("cmd");
+		for (int i=0; i<ncmds; i++){
+			std::string opt = "--option-" + std::to_string(i);
+			subparsers.add_parser("cmd" + std::to_string(i), "command " + std::to_string(i),
+				[opt](argparse::ArgumentParser& sub){
+					sub.add_argument<int>(opt);
+					sub.add_argument("file");
+				});
+		}
+		parser.freeze();
+		
+		std::atomic<int> ready(0);
+		std::vector<std::thread> threads;
+		for (int t=0; t<nthreads; t++){
+			threads.emplace_back([&, t]{
+				ready++;
+				while (ready < nthreads) std::this_thread::yield();
+				for (int r=0; r<reps; r++){
+					int cmd = (t + r) % ncmds;
+					std::string opt = "option_" + std::to_string(cmd);
+					auto result = parser.parse({"-v", "cmd" + std::to_string(cmd), 
+						"--option-" + std::to_string(cmd), std::to_string(r), "file.txt"});
+					check(result.ok(), "parse of cmd" + std::to_string(cmd) + ": " + result.message());
+					if (!result.ok()) continue;
+					argparse::ArgumentMap args = result.args();
+					bool found = (args["cmd"].size() == 1 && args[opt].size() == 1 
+							&& args["file"].size() == 1);
+					check(found, "values of cmd" + std::to_string(cmd));
+					if (!found) continue;
+					check(args["cmd"][0] == "cmd" + std::to_string(cmd), "cmd of cmd" + std::to_string(cmd));
+					check((int)args[opt][0] == r, opt + " of cmd" + std::to_string(cmd));
+					check(args["file"][0] == "file.txt", "file of cmd" + std::to_string(cmd));
+				}
+			});
+		}
+		for (auto& thread : threads) thread.join();
+	}
+	std::printf("%s\n", failures? "FAILED" : "OK");
+	return failures? 1 : 0;
+}
@@ -0,0 +1,78 @@
+// Checks the bounds of number parsing: parse_number() and the values of int
+// and float args accept the whole range of their type and nothing past it,
+// and reject hex, surrounding spaces and trailing or leading junk. Also checks
+// that get<T>() reads the native values kept for bool and count args.
+#include "argparse.h"
+#include <cstdio>
+
+static char prog[] = "test";
+static char* argv0[] = {prog, nullptr};
+static int failures = 0;
+
+static void check(bool cond, const std::string& what){
+	if (cond) return;
+	std::fprintf(stderr, "FAILED: %s\n", what.c_str());
+	failures++;
+}
+
+// Checks whether parse_number() accepts str as a T
+template <typename T>
+static void number(const std::string& str, bool valid, const std::string& type){
+	T num;
+	check(argparse::parse_number(str, num) == valid,
+			"\"" + str + "\" is " + (valid? "not " : "") + "a valid " + type);
+}
+
+int main(){
+	number<int>("2147483647", true, "int");
+	number<int>("-2147483648", true, "int");
+	number<int>("+7", true, "int");
+	number<int>("2147483648", false, "int");
+	number<int>("-2147483649", false, "int");
+	number<float>("3.4e38", true, "float");
+	number<float>("1e39", false, "float");
+	number<double>("1e308", true, "double");
+	number<double>("1e309", false, "double");
+	for (std::string str : {"", "-", "0x10", " 5", "5 ", "5x", "x5", "3.5", "--5", "+-5"})
+		number<int>(str, false, "int");
+	for (std::string str : {"", "0x1p3", " 2.5", "2.5 ", "2.5f", "e5"})
+		number<double>(str, false, "double");
+
+	argparse::ArgumentParser parser(1, argv0);
+	parser.add_help(false);
+	parser.add_argument<int>("--n");
+	parser.add_argument<float>("--x");
+	parser.add_argument<bool>("-v").count();
+	parser.add_argument<bool>("-f");
+	parser.freeze();
+	{
+		auto result = parser.parse({"--n", "-2147483648", "--x", "1e39"});
+		check(result.ok(), "the bounds are rejected: " + result.message());
+		check(result.get<int>("n") == -2147483648, "--n is " + result.get<std::string>("n"));
+		check(result.get<double>("x") == 1e39, "--x is " + result.get<std::string>("x"));
+	}
+	for (std::string str : {"2147483648", "0x10", " 5", "5 ", "5x", "x5", "1.5"}){
+		auto result = parser.parse({"--n", str});
+		check(!result.ok(), "--n accepts \"" + str + "\"");
+		check(result.message() == "argument --n: invalid int value: '" + str + "'",
+				"--n reports \"" + result.message() + "\"");
+	}
+	for (std::string str : {"1e400", "0x10", " 2.5", "2.5x"}){
+		auto result = parser.parse({"--x", str});
+		check(!result.ok(), "--x accepts \"" + str + "\"");
+		check(result.message() == "argument --x: invalid float value: '" + str + "'",
+				"--x reports \"" + result.message() + "\"");
+	}
+	{
+		// The text of -f is "True", which get<int>() could not convert, so it
+		// reads the native bool
+		auto result = parser.parse({"-vvv", "-f"});
+		check(result.ok(), "\"-vvv -f\" is rejected: " + result.message());
+		check(result.get<int>("v") == 3 && result.get<double>("v") == 3, "-vvv counts "
+				+ result.get<std::string>("v"));
+		check(result.get<bool>("f") && result.get<int>("f") == 1, "-f is not stored as true");
+	}
+	if (failures) std::printf("FAILED (%d)\n", failures);
+	else std::printf("OK\n");
+	return failures? 1 : 0;
+}
@@ -0,0 +1,60 @@
+// Parses a batch of command lines with parse_many() on several threads (and
+// on one), and checks that each result is at the index of its line, with the
+// values of that line, and that an invalid line only fails its own result,
+// with the message parse() gives for it. Run under -fsanitize=thread (the
+// default TEST_FLAGS) to catch data races between the workers.
+#include "argparse.h"
+#include <cstdio>
+
+static char prog[] = "test";
+static char* argv0[] = {prog, nullptr};
+static int failures = 0;
+
+static void check(bool cond, const std::string& what){
+	if (cond) return;
+	std::fprintf(stderr, "FAILED: %s\n", what.c_str());
+	failures++;
+}
+
+int main(){
+	argparse::ArgumentParser parser(1, argv0);
+	parser.add_argument<int>("--n");
+	auto& subparsers = parser.add_subparsers().dest("cmd");
+	subparsers.add_parser("run", "run a file", [](argparse::ArgumentParser& run){
+		run.add_argument("file");
+	});
+	parser.freeze();
+
+	// Every 7th line has an invalid int
+	const int nlines = 1000;
+	std::vector<std::vector<std::string>> batch;
+	for (int i=0; i<nlines; i++){
+		std::string n = (i % 7 == 3? "bad" + std::to_string(i) : std::to_string(i));
+		batch.push_back({"--n", n, "run", "file" + std::to_string(i)});
+	}
+
+	for (int nthreads : {1, 4, 16}){
+		std::string threads = " (" + std::to_string(nthreads) + " threads)";
+		auto results = parser.parse_many(batch, nthreads);
+		check(results.size() == nlines, std::to_string(results.size()) + " results" + threads);
+		if (results.size() != nlines) continue;
+		for (int i=0; i<nlines; i++){
+			std::string line = "line " + std::to_string(i) + threads;
+			if (i % 7 == 3){
+				std::string message = parser.parse(batch[i]).message();
+				check(!results[i].ok(), line + " is accepted");
+				check(results[i].message() == message, line + " reports \""
+						+ results[i].message() + "\", parse \"" + message + "\"");
+				continue;
+			}
+			check(results[i].ok(), line + " is rejected: " + results[i].message());
+			if (!results[i].ok()) continue;
+			check(results[i].get<int>("n") == i, line + " has --n " + results[i].get<std::string>("n"));
+			check(results[i].get<std::string>("file") == "file" + std::to_string(i),
+					line + " has file " + results[i].get<std::string>("file"));
+		}
+	}
+	if (failures) std::printf("FAILED (%d)\n", failures);
+	else std::printf("OK\n");
+	return failures? 1 : 0;
+}
@@ -0,0 +1,71 @@
+// Pushes command lines one token at a time and checks that the PushParser
+// only reports Complete when parse() accepts the same line, in particular
+// for required posargs that follow a '+' or '*' one, and that it reports
+// ambiguous options like parse() does.
+#include "argparse.h"
+#include <cstdio>
+
+static char prog[] = "test";
+static char* argv0[] = {prog, nullptr};
+static int failures = 0;
+
+static void check(bool cond, const std::string& what){
+	if (cond) return;
+	std::fprintf(stderr, "FAILED: %s\n", what.c_str());
+	failures++;
+}
+
+// Pushes each prefix of line and compares the status with a full parse
+static void compare(const argparse::ArgumentParser& parser, const std::string& schema, 
+		const std::vector<std::string>& line, int needed){
+	argparse::PushParser push(parser);
+	std::string given = "";
+	auto status = push.status();
+	for (int i=0; i<=line.size(); i++){
+		if (i > 0){
+			status = push.push(line[i-1]);
+			given += (i > 1? " " : "") + line[i-1];
+		}
+		std::vector<std::string> prefix(line.begin(), line.begin()+i);
+		bool ok = parser.parse(prefix).ok();
+		check(ok == (status == argparse::PushParser::Status::Complete), 
+				schema + ": \"" + given + "\" is " + (ok? "accepted" : "rejected") + " by parse()");
+	}
+	check(push.needed() == needed, schema + ": \"" + given + "\" needs " 
+			+ std::to_string(push.needed()) + " more, not " + std::to_string(needed));
+}
+
+int main(){
+	{
+		argparse::ArgumentParser parser(1, argv0);
+		parser.add_argument("a");
+		parser.add_argument("b").nargs('+');
+		parser.add_argument("c");
+		parser.freeze();
+		compare(parser, "a b+ c", {"1", "2"}, 1);
+		compare(parser, "a b+ c", {"1", "2", "3", "4"}, 0);
+	}
+	{
+		argparse::ArgumentParser parser(1, argv0);
+		parser.add_argument("a").nargs('*');
+		parser.add_argument("b");
+		parser.add_argument("c").nargs('+');
+		parser.add_argument("d");
+		parser.freeze();
+		compare(parser, "a* b c+ d", {"1"}, 2);
+		compare(parser, "a* b c+ d", {"1", "2", "3", "4", "5"}, 0);
+	}
+	{
+		argparse::ArgumentParser parser(1, argv0);
+		parser.add_argument("--verbose");
+		parser.add_argument("--version-file");
+		parser.freeze();
+		argparse::PushParser push(parser);
+		push.push("--ver");
+		std::string message = parser.parse({"--ver"}).message();
+		check(push.message() == message, "push reports \"" + push.message() + "\", parse \"" + message + "\"");
+	}
+	if (failures) std::printf("FAILED (%d)\n", failures);
+	else std::printf("OK\n");
+	return failures? 1 : 0;
+}
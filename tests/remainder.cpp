@@ -0,0 +1,75 @@
+// Parses REMAINDER args and checks that an optarg one takes every token after
+// it (including '--' and tokens that look like options), that a posarg one
+// takes the tokens after the posargs before it, and that span() returns them
+// as the null-terminated tail of argv, or empty once the result owns its
+// values or when it was parsed from strings.
+#include "argparse.h"
+#include <cstdio>
+
+static char prog[] = "test";
+static char* argv0[] = {prog, nullptr};
+static int failures = 0;
+
+static void check(bool cond, const std::string& what){
+	if (cond) return;
+	std::fprintf(stderr, "FAILED: %s\n", what.c_str());
+	failures++;
+}
+
+// Checks that dest holds values, and that span(dest) is the run of argv
+// starting at first (or empty if first is negative)
+static void expect(const argparse::ParseResult& result, const char* const* argv,
+		const std::string& dest, const std::vector<std::string>& values, int first){
+	auto got = result.values(dest);
+	std::string text = "", want = "";
+	for (const auto& val : got) text += "[" + std::string(val) + "]";
+	for (const auto& val : values) want += "[" + val + "]";
+	check(text == want, dest + " holds " + text + ", not " + want);
+
+	auto span = result.span(dest);
+	if (first < 0){
+		check(span.empty(), dest + " has a span of " + std::to_string(span.size()));
+		return;
+	}
+	check(span.begin() == argv+first && span.size() == values.size(),
+			dest + " does not span argv[" + std::to_string(first) + "...]");
+	check(!span.empty() && *span.end() == nullptr, dest + " span is not null-terminated");
+}
+
+int main(){
+	{
+		const char* argv[] = {"prog", "-v", "--exec", "run", "--", "-x", "--flag", "a", nullptr};
+		argparse::ArgumentParser parser(1, argv0);
+		parser.add_argument<bool>("-v");
+		parser.add_argument<bool>("-x");
+		parser.add_argument("--exec").nargs(argparse::REMAINDER);
+		parser.freeze();
+		auto result = parser.parse(8, argv);
+		check(result.ok(), "optarg REMAINDER is rejected: " + result.message());
+		expect(result, argv, "exec", {"run", "--", "-x", "--flag", "a"}, 3);
+		check(result.get<bool>("v") && !result.get<bool>("x"), "-v/-x are not stored as given");
+	}
+	{
+		const char* argv[] = {"prog", "in", "out", "cmd", "-v", "--", "x", nullptr};
+		argparse::ArgumentParser parser(1, argv0);
+		parser.add_argument<bool>("-v");
+		parser.add_argument("a");
+		parser.add_argument("b");
+		parser.add_argument("rest").nargs(argparse::REMAINDER);
+		parser.freeze();
+		auto result = parser.parse(7, argv);
+		check(result.ok(), "posarg REMAINDER is rejected: " + result.message());
+		check(result.get<std::string>("b") == "out", "b is not \"out\"");
+		expect(result, argv, "rest", {"cmd", "-v", "--", "x"}, 3);
+		check(!result.get<bool>("v"), "-v after the REMAINDER is stored");
+
+		result.own();
+		expect(result, argv, "rest", {"cmd", "-v", "--", "x"}, -1);
+		auto strings = parser.parse({"in", "out", "cmd", "-v", "--", "x"});
+		check(strings.ok(), "posarg REMAINDER is rejected from strings: " + strings.message());
+		expect(strings, argv, "rest", {"cmd", "-v", "--", "x"}, -1);
+	}
+	if (failures) std::printf("FAILED (%d)\n", failures);
+	else std::printf("OK\n");
+	return failures? 1 : 0;
+}